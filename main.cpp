@@ -1,261 +1,171 @@
-
-#include <GL/glew.h>
 #include <GLFW/glfw3.h>
-#include <glm/glm.hpp> // 用glm处理向量/矩阵（需链接glm库）
+#include "windrt.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
-// ===================== 数据结构定义 =====================
-// 形状类型枚举
-enum ShapeType : int
-{
-    SHAPE_CIRCLE = 0,
-    SHAPE_RECT = 1,
-    SHAPE_SECTOR = 2
-};
+using namespace windrt;
+
+// 窗口尺寸
+const int WINDOW_WIDTH = 1024;
+const int WINDOW_HEIGHT = 768;
+
+WindField* windField = nullptr; // 演示用风场
 
-// 单个形状的风场参数
-struct WindShape
+// ===================== 可视化风场向量（箭头/颜色） =====================
+// 可视化模式：颜色（RG=向量xy）、LIC流线纹理或查表色带；箭头为叠加层
+enum VisMode : int
 {
-    ShapeType type; // 形状类型
-    int padding0;
-    glm::vec2 pos;     // 中心位置 (x,y)
-    glm::vec2 size;    // 尺寸：圆形(r,0)、矩形(w,h)、扇形(r,0)
-    float rotation;    // 旋转角度（度）：矩形朝向/扇形起始角度
-    float angleRange;  // 扇形终止角度-起始角度（仅扇形有效）
-    glm::vec2 windDir; // 风向（归一化向量）
-    float windSpeed;   // 风速（向量幅值）
-    float padding1;
+    VIS_COLOR = 0,
+    VIS_LIC = 1,
+    VIS_DIRECTION = 2,  // HSV色相=方向，亮度=风速
+    VIS_MAGNITUDE = 3,  // 风速热力图
+    VIS_DIVERGENCE = 4, // 散度（发散/汇聚）
+    VIS_CURL = 5,       // 旋度（逆时针/顺时针）
+    VIS_OVERLAP = 6     // 每像素重叠形状数热力图（开启开销调试）
 };
 
-// 风场全局参数（传递到Shader）
-struct WindFieldParams
+// 色带LUT：1D纹理数组，每层256色，层号=VisMode-VIS_DIRECTION；
+// 切换模式只改uniform，不重新编译Shader
+const int COLORMAP_SIZE = 256;
+const int COLORMAP_COUNT = 4;
+
+struct WindVisState
 {
-    int shapeCount; // 形状数量
-    int rtWidth;    // RT宽度
-    int rtHeight;   // RT高度
-    int padding1;
-    WindShape shapes[128]; // 最多128个形状（可扩展）
+    VisMode mode = VIS_COLOR;
+    bool arrows = false;   // 是否叠加箭头
+    float maxSpeed = 1.0f;   // 归一化用的最大风速
+    float derivScale = 0.1f; // 散度/旋度映射到色带两端的值（每texel）
+    float maxOverlap = 8.0f; // 重叠热力图的满刻度形状数
 };
+WindVisState visState;
 
-// ===================== 全局变量 =====================
-const int RT_WIDTH = 1024;
-const int RT_HEIGHT = 768;
-GLuint computeProgram;      // Compute Shader程序
-GLuint windRT;              // 风场RT（存储向量：RG=xy分量，BA=预留）
-GLuint uboParams;           // 风场参数UBO
-WindFieldParams windParams; // 风场参数
+// 箭头网格：每帧由compute pass采样windRT生成实例，再一次实例化绘制
+const int GLYPH_GRID_X = 64;
+const int GLYPH_GRID_Y = 48;
 
-// ===================== Shader编译 =====================
-GLuint createComputeShader(const char* source)
-{
-    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
-    glShaderSource(shader, 1, &source, NULL);
-    glCompileShader(shader);
+GLuint visFieldProgram; // 颜色模式
+GLuint visLicProgram;   // LIC流线模式
+GLuint visArrowProgram; // 箭头实例绘制
+GLuint glyphGenProgram; // 箭头实例生成（compute）
+GLuint visQuadVAO;      // 全屏四边形
+GLuint visQuadVBO;
+GLuint visEmptyVAO;     // 箭头顶点由gl_VertexID生成，无顶点属性
+GLuint glyphBuffer;     // 间接绘制命令(count, instanceCount, first, baseInstance) + 实例数组
+GLuint colormapLUT;     // 色带LUT（GL_TEXTURE_1D_ARRAY）
 
-    // 检查编译错误
+// 编译并链接顶点+片段Shader程序
+GLuint createRenderProgram(const char* vertSource, const char* fragSource)
+{
+    GLuint shaders[2] = {glCreateShader(GL_VERTEX_SHADER), glCreateShader(GL_FRAGMENT_SHADER)};
+    const char* sources[2] = {vertSource, fragSource};
+    GLuint program = glCreateProgram();
     int success;
     char infoLog[512];
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    for (int i = 0; i < 2; i++)
+    {
+        glShaderSource(shaders[i], 1, &sources[i], NULL);
+        glCompileShader(shaders[i]);
+        glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(shaders[i], 512, NULL, infoLog);
+            std::cerr << "可视化Shader编译失败:\n" << infoLog << std::endl;
+        }
+        glAttachShader(program, shaders[i]);
+    }
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success)
     {
-        glGetShaderInfoLog(shader, 512, NULL, infoLog);
-        std::cerr << "Compute Shader编译失败:\n" << infoLog << std::endl;
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "可视化Program链接失败:\n" << infoLog << std::endl;
     }
-    return shader;
+    glDeleteShader(shaders[0]);
+    glDeleteShader(shaders[1]);
+    return program;
 }
 
-// ===================== 初始化风场RT =====================
-void initWindRT()
+// HSV转RGB（色相h取[0,1)）
+glm::vec3 hsv2rgb(float h, float s, float v)
 {
-    glGenTextures(1, &windRT);
-    glBindTexture(GL_TEXTURE_2D, windRT);
-    // 用RGBA32F存储向量（RG=风向xy，精度足够）
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, RT_WIDTH, RT_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    glm::vec3 rgb;
+    const float k[3] = {1.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    for (int i = 0; i < 3; i++)
+    {
+        float p = std::fabs(glm::fract(h + k[i]) * 6.0f - 3.0f);
+        rgb[i] = v * glm::mix(1.0f, glm::clamp(p - 1.0f, 0.0f, 1.0f), s);
+    }
+    return rgb;
 }
 
-// ===================== 初始化UBO =====================
-void initUBO()
+// 在等间距色标之间线性插值
+glm::vec3 sampleStops(const glm::vec3* stops, int count, float t)
 {
-    glGenBuffers(1, &uboParams);
-    glBindBuffer(GL_UNIFORM_BUFFER, uboParams);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(WindFieldParams), &windParams, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, 0, uboParams); // 绑定到binding=0
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    float x = t * (count - 1);
+    int i = std::min((int)x, count - 2);
+    return glm::mix(stops[i], stops[i + 1], x - i);
 }
 
-// ===================== 初始化Compute Shader =====================
-void initComputeShader()
+// 生成色带LUT：方向色相环、风速热力、散度（蓝-白-红）、旋度（绿-白-紫）
+void initColormapLUT()
 {
-    const char* csSource = R"(
-        #version 430 core
-
-        // 形状类型枚举（与CPU端一致）
-        const int SHAPE_CIRCLE = 0;
-        const int SHAPE_RECT = 1;
-        const int SHAPE_SECTOR = 2;
-
-        // 单个形状参数（与CPU端struct对齐）
-        struct WindShape {
-            int type;           // 形状类型（int占4字节，匹配CPU端enum）
-            float padding0;     // 对齐：int(4) + padding(4) = 8字节
-            vec2 pos;           // 中心位置 (8字节)
-            vec2 size;          // 尺寸 (8字节)
-            float rotation;     // 旋转角度（度）(4字节)
-            float angleRange;   // 扇形角度范围 (4字节)
-            vec2 windDir;       // 风向（归一化）(8字节)
-            float windSpeed;    // 风速 (4字节)
-            float padding1;
-        };
-
-        // 风场全局参数UBO
-        layout(std140, binding = 0) uniform WindFieldParams {
-            int shapeCount;     // 形状数量 (4字节)
-            int rtWidth;        // RT宽度 (4字节)
-            int rtHeight;       // RT高度 (4字节)
-            int padding1;       // 对齐 (4字节)
-            WindShape shapes[128]; // 形状数组
-        } params;
-
-        // 输出RT：RG=风向向量xy，BA=预留（0,0）
-        layout(rgba32f, binding = 1) writeonly uniform image2D windRT;
-
-        // 线程分组：16x16（适配GPU warp大小）
-        layout(local_size_x = 16, local_size_y = 16) in;
-
-        // ===================== 工具函数 =====================
-        // 角度转弧度
-        float deg2rad(float deg) {
-            return deg * 3.1415926535 / 180.0;
-        }
-
-        // 旋转向量（绕原点，逆时针）
-        vec2 rotateVec(vec2 v, float rad) {
-            float c = cos(rad);
-            float s = sin(rad);
-            return vec2(v.x * c - v.y * s, v.x * s + v.y * c);
-        }
-
-        // 判定像素是否在圆形内
-        bool isInCircle(vec2 pixelPos, WindShape shape) {
-            float r = shape.size.x;
-            float dist = length(pixelPos - shape.pos);
-            return dist <= r;
-        }
-
-        // 判定像素是否在旋转矩形内
-        bool isInRect(vec2 pixelPos, WindShape shape) {
-            vec2 halfSize = shape.size * 0.5;
-            vec2 delta = pixelPos - shape.pos;
-            // 将像素相对坐标旋转（反向旋转，抵消矩形旋转）
-            float rad = deg2rad(-shape.rotation);
-            delta = rotateVec(delta, rad);
-            // 判定是否在轴对齐矩形内
-            return abs(delta.x) <= halfSize.x && abs(delta.y) <= halfSize.y;
-        }
-
-        // 判定像素是否在扇形内
-        bool isInSector(vec2 pixelPos, WindShape shape) {
-            float r = shape.size.x;
-            vec2 delta = pixelPos - shape.pos;
-            float dist = length(delta);
-            if (dist > r) return false; // 超出半径
-
-            // 计算像素相对于扇形中心的角度（[0, 360)）
-            float angle = atan(delta.y, delta.x) * 180.0 / 3.1415926535;
-            if (angle < 0.0) angle += 360.0;
-
-            // 扇形起始/终止角度
-            float startAngle = shape.rotation;
-            float endAngle = startAngle + shape.angleRange;
-            // 处理跨360°的情况
-            if (endAngle > 360.0) {
-                return angle >= startAngle || angle <= (endAngle - 360.0);
-            } else {
-                return angle >= startAngle && angle <= endAngle;
-            }
-        }
-
-        // 计算形状对像素的风向向量（带衰减）
-        vec2 getShapeWindVec(vec2 pixelPos, WindShape shape) {
-            // 基础风向向量 = 方向 × 风速
-            vec2 baseVec = shape.windDir * shape.windSpeed;
-
-            return baseVec;
-        }
-
-        // ===================== 主逻辑 =====================
-        void main() {
-            // 获取当前线程对应的像素坐标
-            ivec2 pixelCoord = ivec2(gl_GlobalInvocationID.xy);
-            vec2 pixelPos = vec2(pixelCoord.x, pixelCoord.y);
+    const glm::vec3 heat[] = {glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.35f, 0.05f, 0.45f), glm::vec3(0.85f, 0.2f, 0.2f),
+                              glm::vec3(1.0f, 0.75f, 0.1f), glm::vec3(1.0f, 1.0f, 1.0f)};
+    const glm::vec3 divergence[] = {glm::vec3(0.23f, 0.3f, 0.75f), glm::vec3(1.0f, 1.0f, 1.0f),
+                                    glm::vec3(0.7f, 0.02f, 0.15f)};
+    const glm::vec3 curl[] = {glm::vec3(0.1f, 0.55f, 0.3f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.5f, 0.2f, 0.6f)};
 
-            // 超出RT范围则返回
-            if (pixelCoord.x >= params.rtWidth || pixelCoord.y >= params.rtHeight) {
-                return;
-            }
-
-            // 初始化总风向向量为0
-            vec2 totalWindVec = vec2(0.0);
-
-            // 遍历所有形状，叠加风向
-            for (int i = 0; i < params.shapeCount; i++) {
-                WindShape shape = params.shapes[i];
-                bool isInShape = false;
-
-                // 判定像素是否在当前形状内
-                switch (shape.type) {
-                    case SHAPE_CIRCLE:
-                        isInShape = isInCircle(pixelPos, shape);
-                        break;
-                    case SHAPE_RECT:
-                        isInShape = isInRect(pixelPos, shape);
-                        break;
-                    case SHAPE_SECTOR:
-                        isInShape = isInSector(pixelPos, shape);
-                        break;
-                    default:
-                        isInShape = false;
-                }
-
-                // 若在形状内，叠加风向向量
-                if (isInShape) {
-                    totalWindVec += getShapeWindVec(pixelPos, shape);
-                }
+    std::vector<unsigned char> texels(COLORMAP_SIZE * COLORMAP_COUNT * 4);
+    for (int layer = 0; layer < COLORMAP_COUNT; layer++)
+    {
+        for (int i = 0; i < COLORMAP_SIZE; i++)
+        {
+            float t = (float)i / (COLORMAP_SIZE - 1);
+            glm::vec3 color;
+            switch (layer)
+            {
+            case 0:
+                color = hsv2rgb((float)i / COLORMAP_SIZE, 1.0f, 1.0f); // 色相环首尾相接
+                break;
+            case 1:
+                color = sampleStops(heat, 5, t);
+                break;
+            case 2:
+                color = sampleStops(divergence, 3, t);
+                break;
+            default:
+                color = sampleStops(curl, 3, t);
+                break;
             }
-
-            // 写入RT：RG=向量xy，BA=0（预留）
-            imageStore(windRT, pixelCoord, vec4(totalWindVec, 0.0, 0.0));
+            unsigned char* texel = &texels[(layer * COLORMAP_SIZE + i) * 4];
+            texel[0] = (unsigned char)(color.x * 255.0f + 0.5f);
+            texel[1] = (unsigned char)(color.y * 255.0f + 0.5f);
+            texel[2] = (unsigned char)(color.z * 255.0f + 0.5f);
+            texel[3] = 255;
         }
-    )";
-
-    // 创建并链接Compute Shader
-    GLuint cs = createComputeShader(csSource);
-    computeProgram = glCreateProgram();
-    glAttachShader(computeProgram, cs);
-    glLinkProgram(computeProgram);
-
-    // 检查链接错误
-    int success;
-    char infoLog[512];
-    glGetProgramiv(computeProgram, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(computeProgram, 512, NULL, infoLog);
-        std::cerr << "Compute Program链接失败:\n" << infoLog << std::endl;
     }
 
-    glDeleteShader(cs); // 链接后删除Shader
+    glGenTextures(1, &colormapLUT);
+    glBindTexture(GL_TEXTURE_1D_ARRAY, colormapLUT);
+    glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_1D_ARRAY, 0, GL_RGBA8, COLORMAP_SIZE, COLORMAP_COUNT, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 texels.data());
+    glBindTexture(GL_TEXTURE_1D_ARRAY, 0);
 }
 
-// ===================== 可视化风场向量（箭头/颜色） =====================
-// 绘制风场RT的可视化结果（简化版：用颜色表示向量方向，亮度表示风速）
-void renderWindField(GLuint windRT)
+// 一次性创建可视化用的Shader与缓冲（原先每帧重新编译）
+void initWindVisualization()
 {
     // 简单的可视化Shader（顶点+片段）
     const char* vertSource = R"(
@@ -269,64 +179,190 @@ void renderWindField(GLuint windRT)
         }
     )";
 
+    // 颜色模式：原始RG或按标量查色带
     const char* fragSource = R"(
         #version 430 core
         in vec2 vTexCoord;
         uniform sampler2D windRT;
+        uniform usampler2D overlapRT;
+        uniform sampler1DArray colormap;
+        uniform int visMode;
+        uniform float maxSpeed;
+        uniform float derivScale;
+        uniform float maxOverlap;
         out vec4 fragColor;
 
-        // 将向量转换为HSV颜色（H=方向，V=风速归一化）
-        // vec3 hsv2rgb(vec3 hsv) {
-        //     float h = hsv.x / 360.0;
-        //     float s = hsv.y;
-        //     float v = hsv.z;
+        const int VIS_COLOR = 0;
+        const int VIS_DIRECTION = 2;
+        const int VIS_MAGNITUDE = 3;
+        const int VIS_DIVERGENCE = 4;
+        const int VIS_CURL = 5;
+        const int VIS_OVERLAP = 6;
+        const int HEAT_LAYER = 1; // 风速热力图色带
 
-        //     vec4 K = vec4(1.0, 2.0/3.0, 1.0/3.0, 3.0);
-        //     vec3 p = abs(fract(h + K.xyz) * 6.0 - K.www);
-        //     return v * mix(K.xxx, clamp(p - K.xxx, 0.0, 1.0), s);
-        // }
+        vec2 windAt(ivec2 texel) {
+            return texelFetch(windRT, clamp(texel, ivec2(0), textureSize(windRT, 0) - 1), 0).rg;
+        }
+
+        vec3 lookupLayer(float t, int layer) {
+            return texture(colormap, vec2(clamp(t, 0.0, 1.0), float(layer))).rgb;
+        }
+
+        vec3 lookup(float t) {
+            return lookupLayer(t, visMode - VIS_DIRECTION);
+        }
 
         void main() {
             // 读取风向向量
             vec2 windVec = texture(windRT, vTexCoord).rg;
-            // float speed = length(windVec);
+            if (visMode == VIS_COLOR) {
+                fragColor = vec4(windVec, 0.0, 1.0);
+                return;
+            }
 
-            // // 向量为0则显示黑色
-            // if (speed < 0.001) {
-            //     fragColor = vec4(0.0, 0.0, 0.0, 1.0);
-            //     return;
-            // }
+            float speed = length(windVec);
+            if (visMode == VIS_DIRECTION) {
+                // 方向：0°=右，逆时针一圈对应色带[0,1)，亮度=风速归一化
+                float t = fract(atan(windVec.y, windVec.x) / 6.2831853);
+                fragColor = vec4(lookup(t) * min(speed / maxSpeed, 1.0), 1.0);
+                return;
+            }
+            if (visMode == VIS_MAGNITUDE) {
+                fragColor = vec4(lookup(speed / maxSpeed), 1.0);
+                return;
+            }
+            if (visMode == VIS_OVERLAP) {
+                float overlap = float(texture(overlapRT, vTexCoord).r);
+                fragColor = vec4(lookupLayer(overlap / maxOverlap, HEAT_LAYER), 1.0);
+                return;
+            }
 
-            // // 计算方向（角度）：0°=右，90°=上，180°=左，270°=下
-            // float angle = atan(windVec.y, windVec.x) * 180.0 / 3.1415926535;
-            // if (angle < 0.0) angle += 360.0;
+            // 散度/旋度：中心差分，结果映射到发散型色带（0.5为0）
+            ivec2 texel = ivec2(vTexCoord * vec2(textureSize(windRT, 0)));
+            vec2 dx = (windAt(texel + ivec2(1, 0)) - windAt(texel - ivec2(1, 0))) * 0.5;
+            vec2 dy = (windAt(texel + ivec2(0, 1)) - windAt(texel - ivec2(0, 1))) * 0.5;
+            float value = visMode == VIS_DIVERGENCE ? dx.x + dy.y : dx.y - dy.x;
+            fragColor = vec4(lookup(0.5 + 0.5 * value / derivScale), 1.0);
+        }
+    )";
 
-            // // HSV转RGB：H=角度，S=1，V=风速归一化（最大风速设为10）
-            // vec3 rgb = hsv2rgb(vec3(angle, 1.0, min(speed / 10.0, 1.0)));
-            fragColor = vec4(windVec, 0.0, 1.0);
+    // LIC：沿流线前后各积分若干步，对屏幕空间噪声取平均，亮度乘以风速
+    const char* licSource = R"(
+        #version 430 core
+        in vec2 vTexCoord;
+        uniform sampler2D windRT;
+        uniform vec2 viewSize;   // 视口像素尺寸，噪声与步长都按屏幕像素
+        uniform float maxSpeed;
+        out vec4 fragColor;
+
+        const int LIC_STEPS = 12;
+
+        float hash(vec2 p) {
+            return fract(sin(dot(p, vec2(127.1, 311.7))) * 43758.5453);
+        }
+
+        void main() {
+            vec2 pixel = 1.0 / viewSize;
+            float sum = hash(floor(vTexCoord * viewSize));
+            float weight = 1.0;
+            for (int dirSign = -1; dirSign <= 1; dirSign += 2) {
+                vec2 uv = vTexCoord;
+                for (int i = 0; i < LIC_STEPS; i++) {
+                    vec2 w = texture(windRT, uv).rg;
+                    float len = length(w);
+                    if (len < 1e-5) break;
+                    uv += float(dirSign) * (w / len) * pixel;
+                    sum += hash(floor(uv * viewSize));
+                    weight += 1.0;
+                }
+            }
+            float speed = min(length(texture(windRT, vTexCoord).rg) / maxSpeed, 1.0);
+            fragColor = vec4(vec3(sum / weight) * mix(0.15, 1.0, speed), 1.0);
         }
     )";
 
-    // 编译可视化Shader（简化：直接创建，不封装）
-    GLuint vertShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertShader, 1, &vertSource, NULL);
-    glCompileShader(vertShader);
+    // 箭头：9个顶点（杆身两个三角形+箭头一个三角形），按实例的风向旋转、按风速缩放
+    const char* arrowVertSource = R"(
+        #version 430 core
+        layout(std430, binding = 4) readonly buffer GlyphList {
+            uint vertexCount;
+            uint instanceCount;
+            uint first;
+            uint baseInstance;
+            vec4 glyphs[];      // xy=uv位置，zw=风向量
+        } glyphList;
+
+        uniform vec2 cellSize;  // 一个网格单元在NDC中的尺寸
+        uniform float maxSpeed;
+        out float vSpeed;
+
+        const vec2 ARROW[9] = vec2[9](
+            vec2(-0.5, -0.06), vec2(0.2, -0.06), vec2(0.2, 0.06),
+            vec2(-0.5, -0.06), vec2(0.2, 0.06), vec2(-0.5, 0.06),
+            vec2(0.2, -0.2), vec2(0.5, 0.0), vec2(0.2, 0.2));
 
-    GLuint fragShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragShader, 1, &fragSource, NULL);
-    glCompileShader(fragShader);
+        void main() {
+            vec4 glyph = glyphList.glyphs[gl_InstanceID];
+            float speed = length(glyph.zw);
+            vec2 dir = glyph.zw / speed;
+            vec2 v = ARROW[gl_VertexID] * clamp(speed / maxSpeed, 0.3, 1.0);
+            vec2 rotated = vec2(v.x * dir.x - v.y * dir.y, v.x * dir.y + v.y * dir.x);
+            gl_Position = vec4(glyph.xy * 2.0 - 1.0 + rotated * cellSize, 0.0, 1.0);
+            vSpeed = min(speed / maxSpeed, 1.0);
+        }
+    )";
 
-    GLuint visProgram = glCreateProgram();
-    glAttachShader(visProgram, vertShader);
-    glAttachShader(visProgram, fragShader);
-    glLinkProgram(visProgram);
+    const char* arrowFragSource = R"(
+        #version 430 core
+        in float vSpeed;
+        out vec4 fragColor;
+        void main() {
+            fragColor = vec4(mix(vec3(0.6), vec3(1.0), vSpeed), 1.0);
+        }
+    )";
+
+    // 箭头实例生成：每个网格单元采样一次windRT，风速过小的单元不生成实例
+    const char* glyphGenSource = R"(
+        #version 430 core
+        layout(local_size_x = 8, local_size_y = 8) in;
+        layout(std430, binding = 4) buffer GlyphList {
+            uint vertexCount;
+            uint instanceCount;
+            uint first;
+            uint baseInstance;
+            vec4 glyphs[];
+        } glyphList;
+
+        uniform sampler2D windRT;
+        uniform ivec2 gridSize;
+        uniform float minSpeed;
+
+        void main() {
+            ivec2 cell = ivec2(gl_GlobalInvocationID.xy);
+            if (any(greaterThanEqual(cell, gridSize))) {
+                return;
+            }
+            vec2 uv = (vec2(cell) + 0.5) / vec2(gridSize);
+            vec2 wind = textureLod(windRT, uv, 0.0).rg;
+            if (dot(wind, wind) < minSpeed * minSpeed) {
+                return;
+            }
+            uint slot = atomicAdd(glyphList.instanceCount, 1u);
+            glyphList.glyphs[slot] = vec4(uv, wind);
+        }
+    )";
+
+    visFieldProgram = createRenderProgram(vertSource, fragSource);
+    initColormapLUT();
+    visLicProgram = createRenderProgram(vertSource, licSource);
+    visArrowProgram = createRenderProgram(arrowVertSource, arrowFragSource);
+    glyphGenProgram = createComputeProgram(glyphGenSource);
 
     // 全屏四边形VAO/VBO
-    GLuint vao, vbo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glGenVertexArrays(1, &visQuadVAO);
+    glGenBuffers(1, &visQuadVBO);
+    glBindVertexArray(visQuadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, visQuadVBO);
     // 顶点数据：pos(xy) + texCoord(xy)
     float vertices[] = {-1.0f, -1.0f, 0.0f, 0.0f, 1.0f,  -1.0f, 1.0f, 0.0f,
                         1.0f,  1.0f,  1.0f, 1.0f, -1.0f, 1.0f,  0.0f, 1.0f};
@@ -335,26 +371,592 @@ void renderWindField(GLuint windRT)
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glGenVertexArrays(1, &visEmptyVAO);
+    glBindVertexArray(0);
 
-    // 绘制全屏四边形
-    glUseProgram(visProgram);
+    // 箭头缓冲：头部为DrawArraysIndirectCommand(9, 0, 0, 0)，每帧只重置instanceCount
+    GLuint header[4] = {9, 0, 0, 0};
+    glGenBuffers(1, &glyphBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, glyphBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(header) + GLYPH_GRID_X * GLYPH_GRID_Y * sizeof(glm::vec4), NULL,
+                 GL_DYNAMIC_COPY);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), header);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// 箭头叠加层：compute生成实例 -> 一次间接实例化绘制，CPU不回读
+void renderWindArrows(GLuint windRT)
+{
+    const GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, glyphBuffer);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, sizeof(GLuint), sizeof(GLuint), GL_RED_INTEGER,
+                         GL_UNSIGNED_INT, &zero);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, glyphBuffer);
+
+    glUseProgram(glyphGenProgram);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, windRT);
+    glUniform1i(glGetUniformLocation(glyphGenProgram, "windRT"), 0);
+    glUniform2i(glGetUniformLocation(glyphGenProgram, "gridSize"), GLYPH_GRID_X, GLYPH_GRID_Y);
+    glUniform1f(glGetUniformLocation(glyphGenProgram, "minSpeed"), visState.maxSpeed * 0.02f);
+    glDispatchCompute((GLYPH_GRID_X + 7) / 8, (GLYPH_GRID_Y + 7) / 8, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+    glUseProgram(visArrowProgram);
+    glUniform2f(glGetUniformLocation(visArrowProgram, "cellSize"), 2.0f / GLYPH_GRID_X, 2.0f / GLYPH_GRID_Y);
+    glUniform1f(glGetUniformLocation(visArrowProgram, "maxSpeed"), visState.maxSpeed);
+    glBindVertexArray(visEmptyVAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, glyphBuffer);
+    glDrawArraysIndirect(GL_TRIANGLES, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// 绘制风场RT的可视化结果（颜色或LIC，可叠加箭头）
+void renderWindField(GLuint windRT, int viewWidth, int viewHeight)
+{
+    GLuint program = visState.mode == VIS_LIC ? visLicProgram : visFieldProgram;
+    glUseProgram(program);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, windRT);
-    glUniform1i(glGetUniformLocation(visProgram, "windRT"), 0);
-    glBindVertexArray(vao);
+    glUniform1i(glGetUniformLocation(program, "windRT"), 0);
+    glUniform1f(glGetUniformLocation(program, "maxSpeed"), visState.maxSpeed);
+    if (visState.mode == VIS_LIC)
+    {
+        glUniform2f(glGetUniformLocation(program, "viewSize"), (float)viewWidth, (float)viewHeight);
+    }
+    else
+    {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_1D_ARRAY, colormapLUT);
+        glUniform1i(glGetUniformLocation(program, "colormap"), 1);
+        glUniform1i(glGetUniformLocation(program, "visMode"), visState.mode);
+        glUniform1f(glGetUniformLocation(program, "derivScale"), visState.derivScale);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, windField->overlapTexture());
+        glUniform1i(glGetUniformLocation(program, "overlapRT"), 2);
+        glUniform1f(glGetUniformLocation(program, "maxOverlap"), visState.maxOverlap);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // 绘制全屏四边形
+    glBindVertexArray(visQuadVAO);
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 
-    // 释放临时资源
-    glDeleteVertexArrays(1, &vao);
-    glDeleteBuffers(1, &vbo);
-    glDeleteProgram(visProgram);
-    glDeleteShader(vertShader);
-    glDeleteShader(fragShader);
+    if (visState.arrows)
+    {
+        renderWindArrows(windRT);
+    }
+    glBindVertexArray(0);
+}
+
+void destroyWindVisualization()
+{
+    glDeleteProgram(visFieldProgram);
+    glDeleteProgram(visLicProgram);
+    glDeleteProgram(visArrowProgram);
+    glDeleteProgram(glyphGenProgram);
+    glDeleteVertexArrays(1, &visQuadVAO);
+    glDeleteVertexArrays(1, &visEmptyVAO);
+    glDeleteBuffers(1, &visQuadVBO);
+    glDeleteBuffers(1, &glyphBuffer);
+    glDeleteTextures(1, &colormapLUT);
+}
+
+// ===================== GPU粒子 =====================
+// 粒子位置只存在于SSBO中：风场库的查询pass写出每个粒子的风速，平流pass积分位置，
+// 再直接从同一缓冲绘制点，全程没有CPU回读
+const int PARTICLE_COUNT = 65536;
+const float PARTICLE_LIFETIME = 4.0f; // 秒，到期后在视口内随机重生
+
+bool particlesEnabled = false;
+GLuint particleBuffer;     // vec4：xy=世界坐标，z=年龄，w=随机种子
+GLuint particleWindBuffer; // vec2：查询到的风速
+GLuint particleAdvectProgram;
+GLuint particleDrawProgram;
+
+void initParticles()
+{
+    const char* advectSource = R"(
+        #version 430 core
+        layout(local_size_x = 64) in;
+        layout(std430, binding = 11) buffer Particles {
+            vec4 particles[];
+        };
+        layout(std430, binding = 12) readonly buffer ParticleWind {
+            vec2 wind[];
+        };
+        uniform int particleCount;
+        uniform float dt;
+        uniform float speedScale; // 风速（每秒texel数）到世界单位
+        uniform float lifetime;
+        uniform vec2 viewOrigin;
+        uniform vec2 viewExtent;
+
+        float hash(float n) {
+            return fract(sin(n) * 43758.5453);
+        }
+
+        void main() {
+            int i = int(gl_GlobalInvocationID.x);
+            if (i >= particleCount) {
+                return;
+            }
+            vec4 p = particles[i];
+            p.xy += wind[i] * speedScale * dt;
+            p.z += dt;
+            vec2 uv = (p.xy - viewOrigin) / viewExtent;
+            if (p.z > lifetime || any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0)))) {
+                p.w = hash(p.w + float(i) * 0.013);
+                p.xy = viewOrigin + vec2(p.w, hash(p.w * 7.31)) * viewExtent;
+                p.z = hash(p.w * 3.17) * lifetime;
+            }
+            particles[i] = p;
+        }
+    )";
+
+    const char* drawVertSource = R"(
+        #version 430 core
+        layout(std430, binding = 11) readonly buffer Particles {
+            vec4 particles[];
+        };
+        uniform vec2 viewOrigin;
+        uniform vec2 viewExtent;
+        uniform float lifetime;
+        out float vFade;
+        void main() {
+            vec4 p = particles[gl_VertexID];
+            gl_Position = vec4((p.xy - viewOrigin) / viewExtent * 2.0 - 1.0, 0.0, 1.0);
+            vFade = 1.0 - p.z / lifetime;
+        }
+    )";
+
+    const char* drawFragSource = R"(
+        #version 430 core
+        in float vFade;
+        out vec4 fragColor;
+        void main() {
+            fragColor = vec4(vec3(0.9, 0.95, 1.0) * vFade, 1.0);
+        }
+    )";
+
+    particleAdvectProgram = createComputeProgram(advectSource);
+    particleDrawProgram = createRenderProgram(drawVertSource, drawFragSource);
+
+    // 初始位置在CPU上生成一次，之后只在GPU上更新
+    std::vector<glm::vec4> particles(PARTICLE_COUNT);
+    for (int i = 0; i < PARTICLE_COUNT; i++)
+    {
+        float seed = (float)std::rand() / RAND_MAX;
+        particles[i] = glm::vec4((float)std::rand() / RAND_MAX * WINDOW_WIDTH,
+                                 (float)std::rand() / RAND_MAX * WINDOW_HEIGHT, seed * PARTICLE_LIFETIME, seed);
+    }
+    glGenBuffers(1, &particleBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, particleBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, particles.size() * sizeof(glm::vec4), particles.data(), GL_DYNAMIC_COPY);
+    glGenBuffers(1, &particleWindBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, particleWindBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, PARTICLE_COUNT * sizeof(glm::vec2), NULL, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// 在windField->compute()之后调用：查询风速 -> 平流 -> 绘制
+void updateAndRenderParticles(float dt)
+{
+    const WindFieldConfig& config = windField->config();
+    glm::vec2 viewExtent = glm::vec2(config.rtWidth, config.rtHeight) * config.texelSize;
+
+    // 位置步长4个float（vec4），风速步长2个float
+    windField->queryParticles(particleBuffer, particleWindBuffer, PARTICLE_COUNT, 4, 2);
+
+    glUseProgram(particleAdvectProgram);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, particleBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, particleWindBuffer);
+    glUniform1i(glGetUniformLocation(particleAdvectProgram, "particleCount"), PARTICLE_COUNT);
+    glUniform1f(glGetUniformLocation(particleAdvectProgram, "dt"), dt);
+    glUniform1f(glGetUniformLocation(particleAdvectProgram, "speedScale"), 60.0f * config.texelSize);
+    glUniform1f(glGetUniformLocation(particleAdvectProgram, "lifetime"), PARTICLE_LIFETIME);
+    glUniform2f(glGetUniformLocation(particleAdvectProgram, "viewOrigin"), config.worldOrigin.x, config.worldOrigin.y);
+    glUniform2f(glGetUniformLocation(particleAdvectProgram, "viewExtent"), viewExtent.x, viewExtent.y);
+    glDispatchCompute((PARTICLE_COUNT + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(particleDrawProgram);
+    glUniform2f(glGetUniformLocation(particleDrawProgram, "viewOrigin"), config.worldOrigin.x, config.worldOrigin.y);
+    glUniform2f(glGetUniformLocation(particleDrawProgram, "viewExtent"), viewExtent.x, viewExtent.y);
+    glUniform1f(glGetUniformLocation(particleDrawProgram, "lifetime"), PARTICLE_LIFETIME);
+    glBindVertexArray(visEmptyVAO);
+    glDrawArrays(GL_POINTS, 0, PARTICLE_COUNT);
+    glBindVertexArray(0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void destroyParticles()
+{
+    glDeleteProgram(particleAdvectProgram);
+    glDeleteProgram(particleDrawProgram);
+    glDeleteBuffers(1, &particleBuffer);
+    glDeleteBuffers(1, &particleWindBuffer);
+}
+
+// ===================== 短命阵风 =====================
+// 模拟游戏逻辑线程：每16ms通过命令队列在场景内生成一批小圆形风，到期即删除，
+// 用于压测形状池增删和跨线程提交
+const int GUSTS_PER_TICK = 16;
+const double GUST_LIFETIME = 0.1; // 秒
+
+struct Gust
+{
+    WindShapeId id;
+    double expireTime;
+};
+
+std::atomic<bool> gustsRunning(false);
+std::thread gustThread;
+
+void gustWorkerLoop()
+{
+    std::deque<Gust> gusts;
+    std::mt19937 rng(std::random_device{}());
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    auto start = std::chrono::steady_clock::now();
+    while (gustsRunning.load())
+    {
+        double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        while (!gusts.empty() && gusts.front().expireTime <= now)
+        {
+            windField->queueRemoveShape(gusts.front().id);
+            gusts.pop_front();
+        }
+        for (int i = 0; i < GUSTS_PER_TICK; i++)
+        {
+            float angle = unit(rng) * 6.2831853f;
+            WindShape gust;
+            gust.type = SHAPE_CIRCLE;
+            gust.pos = glm::vec2(unit(rng) * WINDOW_WIDTH, unit(rng) * WINDOW_HEIGHT);
+            gust.size = glm::vec2(20.0f + 30.0f * unit(rng));
+            gust.windDir = glm::vec2(std::cos(angle), std::sin(angle));
+            gust.windSpeed = 0.6f;
+            gusts.push_back(Gust{windField->queueAddShape(gust), now + GUST_LIFETIME});
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+    for (const Gust& gust : gusts)
+        windField->queueRemoveShape(gust.id);
+}
+
+void toggleGusts()
+{
+    if (gustsRunning.load())
+    {
+        gustsRunning = false;
+        gustThread.join();
+    }
+    else
+    {
+        gustsRunning = true;
+        gustThread = std::thread(gustWorkerLoop);
+    }
+}
+
+// 可视化切换键：C=颜色，L=LIC流线，H=方向色相，M=风速，D=散度，V=旋度，O=重叠热力图，A=开关箭头叠加
+void onKey(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if (action != GLFW_PRESS)
+        return;
+    if (key == GLFW_KEY_C)
+        visState.mode = VIS_COLOR;
+    if (key == GLFW_KEY_L)
+        visState.mode = VIS_LIC;
+    if (key == GLFW_KEY_H)
+        visState.mode = VIS_DIRECTION;
+    if (key == GLFW_KEY_M)
+        visState.mode = VIS_MAGNITUDE;
+    if (key == GLFW_KEY_D)
+        visState.mode = VIS_DIVERGENCE;
+    if (key == GLFW_KEY_V)
+        visState.mode = VIS_CURL;
+    if (key == GLFW_KEY_O)
+        visState.mode = VIS_OVERLAP;
+    // 重叠热力图需要开销调试变体，其余模式用正常变体
+    windField->config().costDebug = visState.mode == VIS_OVERLAP;
+    if (key == GLFW_KEY_A)
+        visState.arrows = !visState.arrows;
+    if (key == GLFW_KEY_T)
+        toggleGusts();
+    if (key == GLFW_KEY_P)
+        particlesEnabled = !particlesEnabled;
+    // K：开关风场mip链（下一帧按新级数重建RT）
+    if (key == GLFW_KEY_K)
+        windField->config().mipmaps = !windField->config().mipmaps;
+    // B：开关世界分块流式烘焙
+    if (key == GLFW_KEY_B)
+        windField->streaming().enabled = !windField->streaming().enabled;
+    // 整组开关技能图层：只改图层表的enabled，下一帧随参数头部生效，形状无需重新上传
+    std::vector<WindLayer>& layers = windField->layers();
+    int skill = findWindLayer(layers, "技能");
+    if (key == GLFW_KEY_G && skill >= 0)
+        layers[skill].enabled = !layers[skill].enabled;
+}
+
+// ===================== 演示场景 =====================
+void initDemoScene(std::vector<WindShape>& shapes, std::vector<WindLayer>& layers)
+{
+    // 图层：环境风叠加；技能层覆盖下层，只在场景右半边生效
+    layers.resize(2);
+    layers[0].name = "环境";
+    layers[1].name = "技能";
+    layers[1].blend = BLEND_OVERRIDE;
+    layers[1].useMask = true;
+    layers[1].maskMin = glm::vec2(512.0f, 0.0f);
+    layers[1].maskMax = glm::vec2(1024.0f, 768.0f);
+
+    shapes.resize(9);
+
+    // 形状1：圆形风场（中心(300,400)，半径100，风向向右上，风速5，衰减0.5）
+    shapes[0].type = SHAPE_CIRCLE;
+    shapes[0].pos = glm::vec2(200.0f, 300.0f);
+    shapes[0].size = glm::vec2(100.0f, 0.0f); // 圆形：size.x=半径
+    shapes[0].rotation = 0.0f;
+    shapes[0].angleRange = 0.0f;
+    shapes[0].windDir = glm::normalize(glm::vec2(0.5f, 1.0f)); // 右上
+    shapes[0].windSpeed = 0.5f;
+
+    // 形状2：矩形风场（中心(500,300)，尺寸200x100，旋转45°，风向向左，风速8，衰减0.8）
+    shapes[1].type = SHAPE_RECT;
+    shapes[1].pos = glm::vec2(300.0f, 200.0f);
+    shapes[1].size = glm::vec2(200.0f, 100.0f); // 宽200，高100
+    shapes[1].rotation = 45.0f;                 // 旋转45°
+    shapes[1].angleRange = 0.0f;
+    shapes[1].windDir = glm::normalize(glm::vec2(1.0f, 0.5f)); // 向左
+    shapes[1].windSpeed = .8f;
+    // 矩形8秒旋转一周
+    shapes[1].keyframes = {{0.0f, glm::vec2(300.0f, 200.0f), 45.0f, glm::vec2(200.0f, 100.0f), .8f},
+                           {8.0f, glm::vec2(300.0f, 200.0f), 405.0f, glm::vec2(200.0f, 100.0f), .8f}};
+
+    // 形状3：扇形风场（中心(400,500)，半径150，起始角度30°，范围120°，风向向下，风速6，衰减0.3）
+    shapes[2].type = SHAPE_SECTOR;
+    shapes[2].pos = glm::vec2(400.0f, 500.0f);
+    shapes[2].size = glm::vec2(150.0f, 0.0f);                  // 扇形：size.x=半径
+    shapes[2].rotation = 30.0f;                                // 起始角度30°
+    shapes[2].angleRange = 120.0f;                             // 角度范围120°（终止角度150°）
+    shapes[2].windDir = glm::normalize(glm::vec2(0.0f, 0.3f)); // 向下
+    shapes[2].windSpeed = .6f;
+
+    // 形状4：胶囊风场（中心(750,600)，长200，半径30，旋转-20°，风向向右）
+    shapes[3].type = SHAPE_CAPSULE;
+    shapes[3].pos = glm::vec2(750.0f, 600.0f);
+    shapes[3].size = glm::vec2(200.0f, 30.0f); // 胶囊：size.x=长度，size.y=半径
+    shapes[3].rotation = -20.0f;
+    shapes[3].windDir = glm::normalize(glm::vec2(1.0f, 0.0f));
+    shapes[3].windSpeed = .7f;
+
+    // 形状5：多边形风场（L形，一个多边形代替多个矩形）
+    shapes[4].type = SHAPE_POLYGON;
+    shapes[4].pos = glm::vec2(750.0f, 250.0f);
+    shapes[4].points = {glm::vec2(-120.0f, -100.0f), glm::vec2(120.0f, -100.0f), glm::vec2(120.0f, -40.0f),
+                            glm::vec2(-60.0f, -40.0f),   glm::vec2(-60.0f, 100.0f), glm::vec2(-120.0f, 100.0f)};
+    shapes[4].rotation = 10.0f;
+    shapes[4].windDir = glm::normalize(glm::vec2(0.2f, 1.0f));
+    shapes[4].windSpeed = .9f;
+
+    // 形状6：样条管道风场（沿曲线的风道，半径20）
+    shapes[5].type = SHAPE_SPLINE_TUBE;
+    shapes[5].pos = glm::vec2(500.0f, 650.0f);
+    shapes[5].size = glm::vec2(20.0f, 0.0f); // 样条管道：size.x=半径
+    shapes[5].points = {glm::vec2(-200.0f, 0.0f), glm::vec2(-80.0f, 60.0f), glm::vec2(40.0f, -40.0f),
+                            glm::vec2(160.0f, 30.0f)};
+    shapes[5].windDir = glm::normalize(glm::vec2(1.0f, 0.2f));
+    shapes[5].windSpeed = .5f;
+
+    // 形状7：涡旋（中心(180,620)，半径120，核半径30，逆时针）
+    shapes[6].type = SHAPE_VORTEX;
+    shapes[6].pos = glm::vec2(180.0f, 620.0f);
+    shapes[6].size = glm::vec2(120.0f, 30.0f); // 涡旋：size.x=半径，size.y=核半径
+    shapes[6].windSpeed = .8f;
+    // 涡旋沿三角路线循环移动（6秒一圈），由GPU关键帧动画求值
+    shapes[6].keyframes = {{0.0f, glm::vec2(180.0f, 620.0f), 0.0f, glm::vec2(120.0f, 30.0f), .8f},
+                           {2.0f, glm::vec2(420.0f, 700.0f), 0.0f, glm::vec2(100.0f, 25.0f), .6f},
+                           {4.0f, glm::vec2(300.0f, 560.0f), 0.0f, glm::vec2(140.0f, 35.0f), 1.0f},
+                           {6.0f, glm::vec2(180.0f, 620.0f), 0.0f, glm::vec2(120.0f, 30.0f), .8f}};
+
+    // 形状8：爆炸径向风（中心(560,420)，半径100，线性衰减）
+    shapes[7].type = SHAPE_RADIAL;
+    shapes[7].pos = glm::vec2(560.0f, 420.0f);
+    shapes[7].size = glm::vec2(100.0f, 0.0f);
+    shapes[7].windSpeed = .6f;
+    shapes[7].falloff = 1.0f;
+    shapes[7].layer = 1;
+
+    // 形状9：汇（中心(920,120)，半径90，核半径15，风向指向中心）
+    shapes[8].type = SHAPE_SOURCE_SINK;
+    shapes[8].pos = glm::vec2(920.0f, 120.0f);
+    shapes[8].size = glm::vec2(90.0f, 15.0f);
+    shapes[8].windSpeed = -.7f;
+    shapes[8].layer = 1;
+}
+
+// ===================== 无窗口基准 =====================
+// 创建不显示的窗口作为GL上下文
+GLFWwindow* createHiddenWindow()
+{
+    if (!glfwInit())
+    {
+        std::cerr << "GLFW初始化失败" << std::endl;
+        return nullptr;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Wind Field", NULL, NULL);
+    glfwMakeContextCurrent(window);
+    glewInit();
+    return window;
+}
+
+// 按当前配置预热（编译变体）后，用新的计时器只对风场调度计时frames帧，返回平均GPU耗时（毫秒）；
+// 预热帧不计时，结束后取回剩余查询，样本不会混入下一次测量
+double measureWindDispatch(int frames)
+{
+    for (int i = 0; i < GPU_TIMER_FRAMES; i++)
+        windField->compute(0.0f);
+    GpuTimer timer;
+    initGpuTimer(timer);
+    windField->setDispatchTimer(&timer);
+    for (int i = 0; i < frames; i++)
+        windField->compute(0.0f);
+    glFinish();
+    finishGpuTimer(timer);
+    windField->setDispatchTimer(nullptr);
+    double ms = takeGpuTimerAverage(timer);
+    destroyGpuTimer(timer);
+    return ms;
+}
+
+// ===================== 抗锯齿开销基准 =====================
+// 演示场景、1024x768 RT下各抗锯齿模式的风场调度GPU耗时，用于权衡画质与开销（需要GL上下文，窗口不显示）
+int runAABenchmark(int frames)
+{
+    GLFWwindow* window = createHiddenWindow();
+    if (!window)
+        return -1;
+    windField = WindField::create(WindFieldConfig());
+    std::vector<WindShape> shapes;
+    initDemoScene(shapes, windField->layers());
+    for (const WindShape& shape : shapes)
+        windField->addShape(shape);
+
+    struct AAStep
+    {
+        const char* name;
+        AAMode mode;
+        int samples;
+    };
+    const AAStep steps[] = {{"AA_NONE", AA_NONE, 1},
+                            {"AA_ANALYTIC", AA_ANALYTIC, 1},
+                            {"AA_SUPERSAMPLE 2x2", AA_SUPERSAMPLE, 2},
+                            {"AA_SUPERSAMPLE 4x4", AA_SUPERSAMPLE, 4}};
+    WindFieldConfig& config = windField->config();
+    std::cout << "抗锯齿开销: " << config.rtWidth << "x" << config.rtHeight << "，形状" << shapes.size() << "个，"
+              << frames << "帧，" << (const char*)glGetString(GL_RENDERER) << std::endl;
+    double baseMs = 0.0;
+    for (const AAStep& step : steps)
+    {
+        config.aaMode = step.mode;
+        config.aaSamples = step.samples;
+        double ms = measureWindDispatch(frames);
+        if (step.mode == AA_NONE)
+            baseMs = ms;
+        std::cout << step.name << ": " << ms << " ms（" << (baseMs > 0.0 ? ms / baseMs : 0.0) << "x）" << std::endl;
+    }
+
+    delete windField;
+    windField = nullptr;
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
+
+// ===================== 共享内存暂存基准 =====================
+// 高形状数场景下对比风场Shader逐线程读SSBO与共享内存分块暂存的GPU耗时（需要GL上下文，窗口不显示）。
+// 圆形/矩形/扇形/胶囊/涡旋各shapesPerType个，随机撒满整个RT，两种路径用同一场景
+int runStagingBenchmark(int shapesPerType, int frames)
+{
+    GLFWwindow* window = createHiddenWindow();
+    if (!window)
+        return -1;
+
+    windField = WindField::create(WindFieldConfig());
+    const ShapeType types[] = {SHAPE_CIRCLE, SHAPE_RECT, SHAPE_SECTOR, SHAPE_CAPSULE, SHAPE_VORTEX};
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (ShapeType type : types)
+    {
+        for (int i = 0; i < shapesPerType; i++)
+        {
+            float angle = unit(rng) * 360.0f;
+            WindShape shape;
+            shape.type = type;
+            shape.pos = glm::vec2(unit(rng) * WINDOW_WIDTH, unit(rng) * WINDOW_HEIGHT);
+            shape.size = glm::vec2(40.0f + 80.0f * unit(rng), 10.0f + 20.0f * unit(rng));
+            shape.rotation = angle;
+            shape.angleRange = 90.0f;
+            shape.windDir = glm::vec2(std::cos(glm::radians(angle)), std::sin(glm::radians(angle)));
+            shape.windSpeed = 0.5f;
+            windField->addShape(shape);
+        }
+    }
+
+    // 两种路径用同一场景，各自独立计时（见measureWindDispatch）
+    double ms[2] = {0.0, 0.0};
+    for (int staging = 0; staging < 2; staging++)
+    {
+        windField->config().sharedStaging = staging != 0;
+        ms[staging] = measureWindDispatch(frames);
+    }
+    WindFieldStats stats = windField->stats();
+    std::cout << "形状: " << stats.shapes << "（未打包" << stats.droppedShapes << "），" << frames << "帧" << std::endl;
+    std::cout << "逐线程读SSBO: " << ms[0] << " ms，共享内存分块暂存: " << ms[1] << " ms，加速比 "
+              << (ms[1] > 0.0 ? ms[0] / ms[1] : 0.0) << "x" << std::endl;
+
+    delete windField;
+    windField = nullptr;
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
 }
 
 // ===================== 主函数 =====================
-int main()
+int main(int argc, char** argv)
 {
+    // 无窗口模式：定点风场基准与确定性检查
+    // 用法：WindProject --fixed-bench [线程数] [期望哈希(16进制)] [动画tick(毫秒)]
+    if (argc >= 2 && std::string(argv[1]) == "--fixed-bench")
+    {
+        std::vector<WindShape> shapes;
+        std::vector<WindLayer> layers;
+        initDemoScene(shapes, layers);
+        int threads = argc >= 3 ? std::atoi(argv[2]) : (int)std::max(std::thread::hardware_concurrency(), 1u);
+        uint64_t expectedHash = argc >= 4 ? std::strtoull(argv[3], NULL, 16) : 0;
+        int64_t tick = argc >= 5 ? std::strtoll(argv[4], NULL, 10) : 0;
+        return runFixedWindBenchmark(shapes, layers, threads, expectedHash, tick);
+    }
+    // 用法：WindProject --frame-bench [帧数] [每帧阵风数]
+    if (argc >= 2 && std::string(argv[1]) == "--frame-bench")
+    {
+        int frames = argc >= 3 ? std::atoi(argv[2]) : 1000;
+        int gustsPerFrame = argc >= 4 ? std::atoi(argv[3]) : 16;
+        return runFrameBenchmark(frames, gustsPerFrame);
+    }
+    // 用法：WindProject --aa-bench [帧数]
+    if (argc >= 2 && std::string(argv[1]) == "--aa-bench")
+        return runAABenchmark(argc >= 3 ? std::atoi(argv[2]) : 200);
+    // 用法：WindProject --staging-bench [每类形状数(≤128)] [帧数]
+    if (argc >= 2 && std::string(argv[1]) == "--staging-bench")
+    {
+        int shapesPerType = argc >= 3 ? std::atoi(argv[2]) : 128;
+        int frames = argc >= 4 ? std::atoi(argv[3]) : 200;
+        return runStagingBenchmark(shapesPerType, frames);
+    }
+
     // 初始化GLFW
     if (!glfwInit())
     {
@@ -363,69 +965,131 @@ int main()
     }
 
     // 创建窗口
-    GLFWwindow* window = glfwCreateWindow(RT_WIDTH, RT_HEIGHT, "Wind Field", NULL, NULL);
+    GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Wind Field", NULL, NULL);
     glfwMakeContextCurrent(window);
     glewInit();
 
     // 初始化资源
-    initWindRT();
-    initUBO();
-    initComputeShader();
+    windField = WindField::create(WindFieldConfig());
+    initWindVisualization();
+    initParticles();
+    glfwSetKeyCallback(window, onKey);
 
-    // ===================== 初始化风场形状 =====================
-    windParams.shapeCount = 3;
-    windParams.rtWidth = RT_WIDTH;
-    windParams.rtHeight = RT_HEIGHT;
-
-    // 形状1：圆形风场（中心(300,400)，半径100，风向向右上，风速5，衰减0.5）
-    windParams.shapes[0].type = SHAPE_CIRCLE;
-    windParams.shapes[0].pos = glm::vec2(200.0f, 300.0f);
-    windParams.shapes[0].size = glm::vec2(100.0f, 0.0f); // 圆形：size.x=半径
-    windParams.shapes[0].rotation = 0.0f;
-    windParams.shapes[0].angleRange = 0.0f;
-    windParams.shapes[0].windDir = glm::normalize(glm::vec2(0.5f, 1.0f)); // 右上
-    windParams.shapes[0].windSpeed = 0.5f;
-
-    // 形状2：矩形风场（中心(500,300)，尺寸200x100，旋转45°，风向向左，风速8，衰减0.8）
-    windParams.shapes[1].type = SHAPE_RECT;
-    windParams.shapes[1].pos = glm::vec2(300.0f, 200.0f);
-    windParams.shapes[1].size = glm::vec2(200.0f, 100.0f); // 宽200，高100
-    windParams.shapes[1].rotation = 45.0f;                 // 旋转45°
-    windParams.shapes[1].angleRange = 0.0f;
-    windParams.shapes[1].windDir = glm::normalize(glm::vec2(1.0f, 0.5f)); // 向左
-    windParams.shapes[1].windSpeed = .8f;
+    GpuTimer windTimer;
+    GpuTimer visTimer;
+    initGpuTimer(windTimer);
+    initGpuTimer(visTimer);
 
-    // 形状3：扇形风场（中心(400,500)，半径150，起始角度30°，范围120°，风向向下，风速6，衰减0.3）
-    windParams.shapes[2].type = SHAPE_SECTOR;
-    windParams.shapes[2].pos = glm::vec2(400.0f, 500.0f);
-    windParams.shapes[2].size = glm::vec2(150.0f, 0.0f);                  // 扇形：size.x=半径
-    windParams.shapes[2].rotation = 30.0f;                                // 起始角度30°
-    windParams.shapes[2].angleRange = 120.0f;                             // 角度范围120°（终止角度150°）
-    windParams.shapes[2].windDir = glm::normalize(glm::vec2(0.0f, 0.3f)); // 向下
-    windParams.shapes[2].windSpeed = .6f;
-
-    // 更新UBO数据
-    glBindBuffer(GL_UNIFORM_BUFFER, uboParams);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(WindFieldParams), &windParams);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    // ===================== 初始化风场形状 =====================
+    std::vector<WindShape> shapes;
+    initDemoScene(shapes, windField->layers());
+    for (const WindShape& shape : shapes)
+        windField->addShape(shape);
+    // 启动时按本机GPU/驱动选择风场Shader的线程布局（首次计时，之后读缓存）
+    windField->tuneThreadLayout("windrt_tune.txt");
+    // 选定布局后预编译场景用到的变体，编辑场景时不再在帧内编译
+    windField->warmShaderVariants();
 
     glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
 
     // ===================== 主循环 =====================
     while (!glfwWindowShouldClose(window))
     {
-        // 步骤1：调度Compute Shader计算风场向量
-        glUseProgram(computeProgram);
-        glBindImageTexture(1, windRT, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
-        // 启动计算：(宽+15)/16 × (高+15)/16 个工作组
-        glDispatchCompute((RT_WIDTH + 15) / 16, (RT_HEIGHT + 15) / 16, 1);
-        // 等待计算完成（确保RT写入完成）
-        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        WindFieldConfig& config = windField->config();
+        // 数字键切换风场分辨率（覆盖同一片世界区域，texel尺寸随之变化）
+        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+            windField->setResolution(256, 192, 4.0f);
+        if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+            windField->setResolution(1024, 768, 1.0f);
+        if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+            windField->setResolution(4096, 4096, 0.25f);
+        // 4~7切换抗锯齿模式：无、解析覆盖率、2x2超采样、4x4超采样
+        if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS)
+            config.aaMode = AA_NONE;
+        if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS)
+            config.aaMode = AA_ANALYTIC;
+        if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS)
+        {
+            config.aaMode = AA_SUPERSAMPLE;
+            config.aaSamples = 2;
+        }
+        if (glfwGetKey(window, GLFW_KEY_7) == GLFW_PRESS)
+        {
+            config.aaMode = AA_SUPERSAMPLE;
+            config.aaSamples = 4;
+        }
+        // 8：稀疏虚拟风场（16384x16384世界单位，只计算形状覆盖的页）；9：回到整张RT
+        if (glfwGetKey(window, GLFW_KEY_8) == GLFW_PRESS)
+            windField->setVirtualWorld(glm::vec2(-8192.0f), glm::vec2(16384.0f));
+        if (glfwGetKey(window, GLFW_KEY_9) == GLFW_PRESS)
+            config.sparse = false;
+        // 方向键平移视口（玩家位置取视口中心），烘焙chunk随之流式加载
+        float panStep = 4.0f * config.texelSize;
+        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+            config.worldOrigin.x -= panStep;
+        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+            config.worldOrigin.x += panStep;
+        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+            config.worldOrigin.y -= panStep;
+        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+            config.worldOrigin.y += panStep;
+        windField->setPlayerPosition(config.worldOrigin +
+                                     glm::vec2(config.rtWidth, config.rtHeight) * (0.5f * config.texelSize));
+
+        // 步骤1：计算风场（关键帧动画、tile剔除、风场Shader、chunk叠加）
+        beginGpuTimer(windTimer);
+        windField->compute((float)glfwGetTime());
+        endGpuTimer(windTimer);
+        // 稀疏模式覆盖的页超出图集容量时按所需页数扩大图集（下一帧生效）
+        if (config.sparse)
+        {
+            WindFieldStats pageStats = windField->stats();
+            if (pageStats.droppedPages > 0)
+                config.atlasPages = pageStats.neededPages;
+        }
+
+        // 每120帧输出一次风场计算与可视化的平均GPU耗时
+        if (windTimer.frame % 120 == 0)
+        {
+            WindFieldStats stats = windField->stats();
+            std::cout << "风场计算GPU耗时: " << takeGpuTimerAverage(windTimer) << " ms (aaMode=" << config.aaMode
+                      << ", aaSamples=" << config.aaSamples << ")，可视化: " << takeGpuTimerAverage(visTimer)
+                      << " ms" << std::endl;
+            if (config.costDebug)
+            {
+                std::cout << "每帧形状测试次数: " << stats.shapeTests << std::endl;
+            }
+            std::cout << "形状: " << stats.shapes << "，未打包: " << stats.droppedShapes
+                      << "，参数上传: " << stats.uploadBytes << " 字节，队列命令: " << stats.queuedCommands << "（合并后"
+                      << stats.appliedCommands << "）" << std::endl;
+            std::cout << "风场Shader变体: 0x" << std::hex << stats.shaderVariant << std::dec << "（已编译"
+                      << stats.shaderVariants << "个）" << std::endl;
+            std::cout << "帧内存池: " << stats.frameAllocations << "次分配, " << stats.frameBytes
+                      << " 字节，堆上新块: " << stats.frameHeapBlocks << std::endl;
+            if (windField->streaming().enabled)
+            {
+                std::cout << "驻留chunk: " << stats.residentChunks << "/" << stats.chunkCapacity
+                          << "，烘焙中: " << stats.chunksInFlight << "，累计淘汰: " << stats.chunkEvictions
+                          << "，丢弃: " << stats.droppedBakes << std::endl;
+            }
+            if (config.sparse)
+            {
+                std::cout << "驻留页: " << stats.residentPages << "/" << stats.pageCapacity << "，覆盖: " << stats.neededPages
+                          << "，超出容量: " << stats.droppedPages << std::endl;
+            }
+        }
 
         // 步骤2：清空屏幕，渲染风场可视化结果
+        int fbWidth, fbHeight;
+        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+        glViewport(0, 0, fbWidth, fbHeight);
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        renderWindField(windRT);
+        beginGpuTimer(visTimer);
+        renderWindField(windField->texture(), fbWidth, fbHeight);
+        if (particlesEnabled)
+            updateAndRenderParticles(1.0f / 60.0f);
+        endGpuTimer(visTimer);
 
         // 交换缓冲区，处理事件
         glfwSwapBuffers(window);
@@ -433,9 +1097,13 @@ int main()
     }
 
     // ===================== 释放资源 =====================
-    glDeleteProgram(computeProgram);
-    glDeleteTextures(1, &windRT);
-    glDeleteBuffers(1, &uboParams);
+    destroyGpuTimer(windTimer);
+    destroyGpuTimer(visTimer);
+    destroyWindVisualization();
+    destroyParticles();
+    if (gustsRunning.load())
+        toggleGusts();
+    delete windField;
     glfwTerminate();
 
     return 0;
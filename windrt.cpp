@@ -0,0 +1,4742 @@
+// windrt库实现：形状打包、Compute Shader风场计算、稀疏虚拟风场、世界分块流式烘焙、定点求值器
+#include "windrt.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace windrt
+{
+
+// 模块内部的GPU状态与辅助函数放在匿名命名空间，只有windrt.h中声明的接口对外可见
+namespace
+{
+
+// ===================== GPU端分桶形状 =====================
+// 形状按类型分桶，每个桶用紧凑结构体，Shader中每类一个无switch的循环，
+// 同一warp内各线程执行相同指令；三角函数等在CPU打包时预计算
+const int MAX_SHAPES_PER_TYPE = 128;
+const int MAX_SHAPE_VERTICES = 4096;  // 多边形/样条管道共用的顶点缓冲容量
+const int MAX_POLYGON_VERTICES = 64;  // 单个多边形的顶点上限
+const int TUBE_SEGMENTS_PER_SPAN = 8; // 样条每段细分的折线段数
+const int MAX_WIND_LAYERS = 8;
+
+// 圆形（std140下32字节）
+struct GpuCircle
+{
+    glm::vec2 pos;     // 中心位置
+    float radiusSq;    // 半径平方
+    float radius;      // 半径（抗锯齿SDF用）
+    glm::vec2 windVec; // 风向×风速
+    glm::vec2 padding1;
+};
+
+// 旋转矩形（32字节）
+struct GpuRect
+{
+    glm::vec2 pos;      // 中心位置
+    glm::vec2 halfSize; // 半宽/半高
+    glm::vec2 axis;     // (cos, sin)旋转角
+    glm::vec2 windVec;  // 风向×风速
+};
+
+// 扇形（32字节）：用中心方向与半角余弦做点积判定，无需atan
+struct GpuSector
+{
+    glm::vec2 pos;       // 中心位置
+    float radiusSq;      // 半径平方
+    float cosHalfRange;  // cos(角度范围/2)
+    glm::vec2 centerDir; // 扇形角平分线方向
+    glm::vec2 windVec;   // 风向×风速
+};
+
+// 胶囊（32字节）
+struct GpuCapsule
+{
+    glm::vec2 a;       // 线段端点
+    glm::vec2 b;
+    float radius;      // 半径
+    float padding0;
+    glm::vec2 windVec; // 风向×风速
+};
+
+// 顶点缓冲中的路径形状：多边形（闭合）与样条管道（折线+半径），48字节
+struct GpuPath
+{
+    glm::vec2 center; // 包围盒中心
+    glm::vec2 extent; // 包围盒半尺寸（已含半径）
+    int firstVertex;  // 在顶点缓冲中的起始下标
+    int vertexCount;  // 顶点数
+    float radius;     // 管道半径（多边形为0）
+    float padding0;
+    glm::vec2 windVec; // 风向×风速
+    glm::vec2 padding1;
+};
+
+// 按像素偏移计算风向的圆形区域风（32字节），涡旋/径向/源汇各一个桶
+struct GpuFlow
+{
+    glm::vec2 pos;    // 中心位置
+    float radius;     // 作用半径
+    float coreRadius; // 核半径（涡旋/源汇核内风速线性增长，避免中心奇点）
+    float strength;   // 风速，带符号
+    float falloff;    // 径向风衰减指数
+    glm::vec2 padding0;
+};
+
+// 图层（128字节）：同一桶内的形状按图层连续存放，这里记录各桶中本层的区间
+struct GpuLayer
+{
+    int blendMode;
+    int enabled;
+    int useMask;
+    int invertMask;
+    glm::vec2 maskMin;
+    glm::vec2 maskMax;
+    int firstShape[SHAPE_TYPE_COUNT]; // 按ShapeType索引
+    int padding0[3];
+    int shapeCount[SHAPE_TYPE_COUNT];
+    int padding1[3];
+};
+
+// 风场全局参数（传递到Shader）
+struct WindFieldParams
+{
+    int circleCount; // 各桶形状数量
+    int rectCount;
+    int sectorCount;
+    int rtWidth;           // RT宽度
+    int rtHeight;          // RT高度
+    float texelSize;       // 每个texel对应的世界单位
+    glm::vec2 worldOrigin; // RT左下角texel的世界坐标
+    AAMode aaMode;         // 抗锯齿模式
+    int aaSamples;         // 超采样每轴采样数
+    int capsuleCount;
+    int polygonCount;
+    int tubeCount;
+    int vertexCount; // 顶点缓冲已用数量
+    int vortexCount;
+    int radialCount;
+    int sourceSinkCount;
+    int layerCount; // 图层数（至少1）
+    int padding1;
+    int padding2;
+    GpuLayer layers[MAX_WIND_LAYERS]; // 图层表随头部一起写入切片
+    GpuCircle circles[MAX_SHAPES_PER_TYPE];
+    GpuRect rects[MAX_SHAPES_PER_TYPE];
+    GpuSector sectors[MAX_SHAPES_PER_TYPE];
+    GpuCapsule capsules[MAX_SHAPES_PER_TYPE];
+    GpuPath polygons[MAX_SHAPES_PER_TYPE];
+    GpuPath tubes[MAX_SHAPES_PER_TYPE];
+    GpuFlow vortices[MAX_SHAPES_PER_TYPE];
+    GpuFlow radials[MAX_SHAPES_PER_TYPE];
+    GpuFlow sourceSinks[MAX_SHAPES_PER_TYPE];
+    glm::vec2 vertices[MAX_SHAPE_VERTICES];
+};
+
+// CPU与GLSL std140的padding规则不同，布局变化时在编译期报错
+static_assert(sizeof(GpuCircle) == 32 && sizeof(GpuRect) == 32 && sizeof(GpuSector) == 32, "GPU形状必须为32字节");
+static_assert(sizeof(GpuCapsule) == 32 && sizeof(GpuPath) == 48, "胶囊32字节，路径形状48字节");
+static_assert(sizeof(GpuFlow) == 32, "GpuFlow必须为32字节");
+static_assert(sizeof(GpuLayer) == 128, "GpuLayer必须为128字节");
+static_assert(offsetof(WindFieldParams, layers) == 80, "WindFieldParams头部必须为80字节");
+
+// ===================== 全局变量 =====================
+const int TILE_SIZE = 16;   // tile边长，与风场Shader工作组尺寸一致
+GLuint windRT;              // 风场RT（存储向量：RG=xy分量，BA=预留）
+GLuint paramBuffer;         // 风场参数SSBO（持久映射环形缓冲）
+WindFieldParams windParams; // 风场参数（CPU端打包结果）
+
+WindFieldConfig windConfig; // 期望的配置
+int allocatedRTWidth = 0;   // 当前已分配的RT尺寸
+int allocatedRTHeight = 0;
+int allocatedMipLevels = 0; // 风场RT的mip级数（1=无mip链）
+int allocatedTileCapacity = 0; // tile列表容量（tile数）
+
+ChunkStreamConfig chunkConfig; // 世界分块流式烘焙配置
+
+// 参数环形缓冲：一块glBufferStorage分配的缓冲切成N个帧切片，持久+一致映射，
+// CPU直接写当前切片，GPU读上一帧切片，用fence保证不覆盖GPU正在读的数据
+const int PARAM_RING_FRAMES = 3;
+GLsizeiptr paramSliceSize = 0;                     // 单个切片大小（按SSBO偏移对齐）
+char* paramRingPtr = nullptr;                      // 持久映射的CPU指针
+GLsync paramFences[PARAM_RING_FRAMES] = {nullptr}; // 每个切片最后一次使用的fence
+int paramRingIndex = 0;                            // 当前写入的切片
+
+// tile剔除：占用pass把被形状覆盖的tile写入列表，风场Shader只间接调度这些tile
+GLuint tileCullProgram; // 占用pass程序
+GLuint sparseCullProgram;    // 稀疏模式的占用pass变体
+GLuint tileListBuffer;  // SSBO：间接调度参数(x,y,z) + tile数 + tile坐标列表
+
+// 开销调试：重叠数RT与形状测试计数，计数结果按参数环形缓冲的切片回读（复用其fence，无需等待）
+GLuint overlapRT;                     // R32UI：每像素覆盖率>0的形状数
+GLuint costCounterBuffer;             // SSBO：本帧形状测试总数
+GLuint costReadbackBuffer;            // 持久映射的回读缓冲，每个环形切片一个计数
+GLuint* costReadbackPtr = nullptr;
+GLuint lastShapeTests = 0;            // 最近一次取回的形状测试总数
+GpuTimer* dispatchTimer = nullptr;    // 调用方提供的风场调度计时器（见setDispatchTimer）
+
+// ===================== 帧内存池 =====================
+// 每帧临时容器（命令合并表、chunk请求与上传列表、动画上传数组等）的线性分配器：
+// 指针递增分配，释放为空操作，compute()开始时整体重置。块用完时追加新块（已分配的内存不移动），
+// 重置时若用过多个块则合并成一个足够大的块，稳定后每帧不再有堆分配。只能在渲染线程使用
+const size_t FRAME_ARENA_INITIAL_SIZE = 256 * 1024;
+
+struct FrameArenaState
+{
+    std::vector<std::pair<char*, size_t>> blocks; // 块地址与大小
+    size_t block = 0;     // 当前块
+    size_t offset = 0;    // 当前块内已用字节
+    size_t frameBytes = 0;
+    int frameAllocations = 0;
+    int frameBlockAllocations = 0; // 本帧向堆申请新块的次数
+};
+FrameArenaState frameArena;
+
+void* frameAlloc(size_t size, size_t alignment)
+{
+    FrameArenaState& a = frameArena;
+    a.frameAllocations++;
+    a.frameBytes += size;
+    while (true)
+    {
+        if (a.block < a.blocks.size())
+        {
+            size_t start = (a.offset + alignment - 1) / alignment * alignment;
+            if (start + size <= a.blocks[a.block].second)
+            {
+                a.offset = start + size;
+                return a.blocks[a.block].first + start;
+            }
+            if (a.block + 1 < a.blocks.size())
+            {
+                a.block++;
+                a.offset = 0;
+                continue;
+            }
+        }
+        // 新块至少为上一块的两倍
+        size_t blockSize = std::max(size + alignment, a.blocks.empty() ? FRAME_ARENA_INITIAL_SIZE
+                                                                        : a.blocks.back().second * 2);
+        a.blocks.emplace_back((char*)std::malloc(blockSize), blockSize);
+        a.block = a.blocks.size() - 1;
+        a.offset = 0;
+        a.frameBlockAllocations++;
+    }
+}
+
+// 每帧开始时调用：之前分配的内存全部失效
+void resetFrameArena()
+{
+    FrameArenaState& a = frameArena;
+    bool merged = a.blocks.size() > 1;
+    if (merged)
+    {
+        size_t total = 0;
+        for (auto& block : a.blocks)
+        {
+            total += block.second;
+            std::free(block.first);
+        }
+        a.blocks.assign(1, std::make_pair((char*)std::malloc(total), total));
+    }
+    a.block = 0;
+    a.offset = 0;
+    a.frameBytes = 0;
+    a.frameAllocations = 0;
+    // 合并出的新块也是一次堆分配，计入本帧
+    a.frameBlockAllocations = merged ? 1 : 0;
+}
+
+void destroyFrameArena()
+{
+    for (auto& block : frameArena.blocks)
+        std::free(block.first);
+    frameArena = FrameArenaState();
+}
+
+// 供STL容器使用的分配器，容器不能跨帧存活
+template <typename T>
+struct FrameAllocator
+{
+    typedef T value_type;
+
+    FrameAllocator() = default;
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&)
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return (T*)frameAlloc(n * sizeof(T), alignof(T));
+    }
+    void deallocate(T*, size_t)
+    {
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&)
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&)
+{
+    return false;
+}
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+// ===================== Shader编译 =====================
+GLuint createComputeShader(const char* source)
+{
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    // 检查编译错误
+    int success;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cerr << "Compute Shader编译失败:\n" << infoLog << std::endl;
+    }
+    return shader;
+}
+
+} // namespace
+
+// 编译并链接只含一个Compute Shader的程序
+GLuint createComputeProgram(const std::string& source)
+{
+    GLuint cs = createComputeShader(source.c_str());
+    GLuint program = glCreateProgram();
+    glAttachShader(program, cs);
+    glLinkProgram(program);
+
+    // 检查链接错误
+    int success;
+    char infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "Compute Program链接失败:\n" << infoLog << std::endl;
+    }
+
+    glDeleteShader(cs); // 链接后删除Shader
+    return program;
+}
+
+// ===================== GPU计时 =====================
+void initGpuTimer(GpuTimer& timer)
+{
+    glGenQueries(GPU_TIMER_FRAMES, timer.queries);
+}
+
+void beginGpuTimer(GpuTimer& timer)
+{
+    GLuint query = timer.queries[timer.frame % GPU_TIMER_FRAMES];
+    // 复用前取回该查询上一次的结果（GPU_TIMER_FRAMES帧之前发出）
+    if (timer.frame >= GPU_TIMER_FRAMES)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+            timer.totalMs += ns / 1.0e6;
+            timer.sampleCount++;
+        }
+    }
+    glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+void endGpuTimer(GpuTimer& timer)
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    timer.frame++;
+}
+
+// 取平均耗时并清零统计，没有样本时返回0
+double takeGpuTimerAverage(GpuTimer& timer)
+{
+    double avg = timer.sampleCount > 0 ? timer.totalMs / timer.sampleCount : 0.0;
+    timer.totalMs = 0.0;
+    timer.sampleCount = 0;
+    return avg;
+}
+
+// 查询环中最后GPU_TIMER_FRAMES次查询要等复用时才读取，切换测量对象前必须取回，
+// 否则会被计入下一个对象的样本
+void finishGpuTimer(GpuTimer& timer)
+{
+    for (int frame = std::max(timer.frame - GPU_TIMER_FRAMES, 0); frame < timer.frame; frame++)
+    {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(timer.queries[frame % GPU_TIMER_FRAMES], GL_QUERY_RESULT, &ns);
+        timer.totalMs += ns / 1.0e6;
+        timer.sampleCount++;
+    }
+    timer.frame = 0;
+}
+
+void destroyGpuTimer(GpuTimer& timer)
+{
+    glDeleteQueries(GPU_TIMER_FRAMES, timer.queries);
+}
+
+namespace
+{
+
+// ===================== 初始化风场RT =====================
+// 完整mip链的级数（到1x1为止）
+int windMipLevelCount(int width, int height)
+{
+    int levels = 1;
+    while ((std::max(width, height) >> levels) > 0)
+        levels++;
+    return levels;
+}
+
+void initWindRT(int width, int height, int mipLevels)
+{
+    glGenTextures(1, &windRT);
+    glBindTexture(GL_TEXTURE_2D, windRT);
+    // 用RGBA32F存储向量（RG=风向xy，精度足够）；采样方默认双线性，有mip链时在级间也插值
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexStorage2D(GL_TEXTURE_2D, mipLevels, GL_RGBA32F, width, height);
+
+    // 开销调试用的重叠数RT，与风场RT同尺寸
+    glGenTextures(1, &overlapRT);
+    glBindTexture(GL_TEXTURE_2D, overlapRT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// ===================== 初始化参数缓冲 =====================
+// 用glBufferStorage分配不可变存储并持久映射，之后CPU写入无需glBufferSubData拷贝；
+// 九个形状桶（SHAPE_TYPE_COUNT）加顶点缓冲超出UBO保证的16KB，因此用std430 SSBO（此布局下与std140一致）
+void initParamBuffer()
+{
+    GLint alignment = 256;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    paramSliceSize = (sizeof(WindFieldParams) + alignment - 1) / alignment * alignment;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &paramBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, paramBuffer);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, paramSliceSize * PARAM_RING_FRAMES, NULL, flags);
+    paramRingPtr = (char*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, paramSliceSize * PARAM_RING_FRAMES, flags);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    if (!paramRingPtr)
+    {
+        std::cerr << "参数缓冲持久映射失败（需要GL 4.4或ARB_buffer_storage）" << std::endl;
+    }
+}
+
+// 获取当前帧可写的参数切片（等待GPU用完该切片）
+WindFieldParams* acquireParamSlice()
+{
+    GLsync& fence = paramFences[paramRingIndex];
+    if (fence)
+    {
+        // 一般不会真的等待：该切片是PARAM_RING_FRAMES帧之前提交的
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+        {
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    return (WindFieldParams*)(paramRingPtr + paramRingIndex * paramSliceSize);
+}
+
+// 局部坐标点按形状的位置与旋转变换到世界坐标
+glm::vec2 shapeToWorld(const WindShape& shape, glm::vec2 local)
+{
+    float rad = glm::radians(shape.rotation);
+    float c = std::cos(rad);
+    float s = std::sin(rad);
+    return shape.pos + glm::vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+}
+
+// Catmull-Rom样条在p1~p2段上的插值
+glm::vec2 catmullRom(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, float t)
+{
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                   (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+// 为顶点缓冲中[firstVertex, vertexCount)这段顶点计算包围盒（外扩radius）
+void finishPath(GpuPath& path, const WindFieldParams& params, float radius, glm::vec2 windVec)
+{
+    glm::vec2 lo = params.vertices[path.firstVertex];
+    glm::vec2 hi = lo;
+    for (int i = 1; i < path.vertexCount; i++)
+    {
+        lo = glm::min(lo, params.vertices[path.firstVertex + i]);
+        hi = glm::max(hi, params.vertices[path.firstVertex + i]);
+    }
+    path.center = (lo + hi) * 0.5f;
+    path.extent = (hi - lo) * 0.5f + glm::vec2(radius);
+    path.radius = radius;
+    path.windVec = windVec;
+}
+
+// 涡旋/径向/源汇共用的打包
+GpuFlow packFlow(const WindShape& shape)
+{
+    GpuFlow flow = {};
+    flow.pos = shape.pos;
+    flow.radius = shape.size.x;
+    flow.coreRadius = std::max(shape.size.y, 1e-3f);
+    flow.strength = shape.windSpeed;
+    flow.falloff = shape.falloff;
+    return flow;
+}
+
+// 多边形与样条管道的顶点不做关键帧动画
+bool isAnimatable(ShapeType type)
+{
+    return type != SHAPE_POLYGON && type != SHAPE_SPLINE_TUBE;
+}
+
+// 形状类型对应的桶计数
+int* bucketCount(WindFieldParams& params, ShapeType type)
+{
+    switch (type)
+    {
+    case SHAPE_CIRCLE:
+        return &params.circleCount;
+    case SHAPE_RECT:
+        return &params.rectCount;
+    case SHAPE_SECTOR:
+        return &params.sectorCount;
+    case SHAPE_CAPSULE:
+        return &params.capsuleCount;
+    case SHAPE_POLYGON:
+        return &params.polygonCount;
+    case SHAPE_SPLINE_TUBE:
+        return &params.tubeCount;
+    case SHAPE_VORTEX:
+        return &params.vortexCount;
+    case SHAPE_RADIAL:
+        return &params.radialCount;
+    default:
+        return &params.sourceSinkCount;
+    }
+}
+
+// 多边形/样条管道占用的顶点数；其余类型为0，顶点数不合法的路径形状返回-1（不打包）
+int shapeVertexCount(const WindShape& shape)
+{
+    int points = (int)shape.points.size();
+    if (shape.type == SHAPE_POLYGON)
+        return points >= 3 && points <= MAX_POLYGON_VERTICES ? points : -1;
+    if (shape.type == SHAPE_SPLINE_TUBE)
+        return points >= 2 ? (points - 1) * TUBE_SEGMENTS_PER_SPAN + 1 : -1;
+    return 0;
+}
+
+// 按类型把单个形状写入桶中的slot位置；多边形/样条管道的顶点追加到顶点缓冲末尾，
+// 调用方保证形状合法且顶点缓冲有足够空间
+void packWindShapeAt(const WindShape& shape, WindFieldParams& params, int slot)
+{
+    // 关键帧动画形状只占用桶位置，内容由GPU动画pass写入
+    if (!shape.keyframes.empty() && isAnimatable(shape.type))
+        return;
+
+    glm::vec2 windVec = shape.windDir * shape.windSpeed;
+    switch (shape.type)
+    {
+    case SHAPE_CIRCLE:
+    {
+        GpuCircle& c = params.circles[slot];
+        c.pos = shape.pos;
+        c.radiusSq = shape.size.x * shape.size.x;
+        c.radius = shape.size.x;
+        c.windVec = windVec;
+        break;
+    }
+    case SHAPE_RECT:
+    {
+        float rad = glm::radians(shape.rotation);
+        GpuRect& r = params.rects[slot];
+        r.pos = shape.pos;
+        r.halfSize = shape.size * 0.5f;
+        r.axis = glm::vec2(std::cos(rad), std::sin(rad));
+        r.windVec = windVec;
+        break;
+    }
+    case SHAPE_SECTOR:
+    {
+        float centerRad = glm::radians(shape.rotation + shape.angleRange * 0.5f);
+        GpuSector& sec = params.sectors[slot];
+        sec.pos = shape.pos;
+        sec.radiusSq = shape.size.x * shape.size.x;
+        sec.cosHalfRange = std::cos(glm::radians(shape.angleRange * 0.5f));
+        sec.centerDir = glm::vec2(std::cos(centerRad), std::sin(centerRad));
+        sec.windVec = windVec;
+        break;
+    }
+    case SHAPE_CAPSULE:
+    {
+        glm::vec2 halfAxis(shape.size.x * 0.5f, 0.0f);
+        GpuCapsule& cap = params.capsules[slot];
+        cap.a = shapeToWorld(shape, -halfAxis);
+        cap.b = shapeToWorld(shape, halfAxis);
+        cap.radius = shape.size.y;
+        cap.windVec = windVec;
+        break;
+    }
+    case SHAPE_POLYGON:
+    {
+        GpuPath& poly = params.polygons[slot];
+        poly.firstVertex = params.vertexCount;
+        poly.vertexCount = (int)shape.points.size();
+        for (glm::vec2 p : shape.points)
+        {
+            params.vertices[params.vertexCount++] = shapeToWorld(shape, p);
+        }
+        finishPath(poly, params, 0.0f, windVec);
+        break;
+    }
+    case SHAPE_SPLINE_TUBE:
+    {
+        // 控制点细分为折线，首尾控制点重复以使曲线经过端点
+        int spans = (int)shape.points.size() - 1;
+        GpuPath& tube = params.tubes[slot];
+        tube.firstVertex = params.vertexCount;
+        tube.vertexCount = shapeVertexCount(shape);
+        for (int span = 0; span < spans; span++)
+        {
+            glm::vec2 p0 = shape.points[std::max(span - 1, 0)];
+            glm::vec2 p1 = shape.points[span];
+            glm::vec2 p2 = shape.points[span + 1];
+            glm::vec2 p3 = shape.points[std::min(span + 2, spans)];
+            for (int i = 0; i < TUBE_SEGMENTS_PER_SPAN; i++)
+            {
+                float t = (float)i / TUBE_SEGMENTS_PER_SPAN;
+                params.vertices[params.vertexCount++] = shapeToWorld(shape, catmullRom(p0, p1, p2, p3, t));
+            }
+        }
+        params.vertices[params.vertexCount++] = shapeToWorld(shape, shape.points.back());
+        finishPath(tube, params, shape.size.x, windVec);
+        break;
+    }
+    case SHAPE_VORTEX:
+        params.vortices[slot] = packFlow(shape);
+        break;
+    case SHAPE_RADIAL:
+        params.radials[slot] = packFlow(shape);
+        break;
+    case SHAPE_SOURCE_SINK:
+        params.sourceSinks[slot] = packFlow(shape);
+        break;
+    }
+}
+
+// ===================== 图层打包 =====================
+// 实际使用的图层数：至少一层（未配置图层时为默认叠加层）
+int packedLayerCount(const std::vector<WindLayer>& layers)
+{
+    return std::min(std::max((int)layers.size(), 1), MAX_WIND_LAYERS);
+}
+
+// 越界的图层下标归到最近的有效图层
+int shapeLayerIndex(const WindShape& shape, int layerCount)
+{
+    return std::min(std::max(shape.layer, 0), layerCount - 1);
+}
+
+} // namespace
+
+int findWindLayer(const std::vector<WindLayer>& layers, const std::string& name)
+{
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (layers[i].name == name)
+            return (int)i;
+    }
+    return -1;
+}
+
+namespace
+{
+
+// ===================== 形状池 =====================
+// 句柄 = 代数<<20 | 槽位下标：低20位槽位下标，其上11位代数（1..2047循环），最高位留给队列id；
+// 槽位复用时代数加一，旧句柄随之失效。
+// 形状稠密存放，删除时与末尾交换；GPU桶内同层形状连续（按图层分段），
+// 增删只在段首尾各挪动一个形状，每次操作最多搬移图层数个槽位。
+// 每个环形切片记录各桶的脏区间，写切片时只拷贝上次写入后变化的槽位
+const int SHAPE_HANDLE_INDEX_BITS = 20;
+const uint32_t SHAPE_HANDLE_INDEX_MASK = (1u << SHAPE_HANDLE_INDEX_BITS) - 1;
+const uint32_t SHAPE_HANDLE_MAX_GENERATION = (1u << (31 - SHAPE_HANDLE_INDEX_BITS)) - 1;
+const int VERTEX_BUCKET = SHAPE_TYPE_COUNT; // 脏区间中顶点缓冲的下标
+const int PACKED_NONE = -1;                 // 未打包：路径形状顶点数不合法
+const int PACKED_DROPPED = -2;              // 未打包：桶或顶点缓冲已满
+
+// 各桶（及顶点缓冲）在WindFieldParams中的偏移与元素大小，按ShapeType索引
+const size_t BUCKET_OFFSET[SHAPE_TYPE_COUNT + 1] = {
+    offsetof(WindFieldParams, circles),  offsetof(WindFieldParams, rects),    offsetof(WindFieldParams, sectors),
+    offsetof(WindFieldParams, capsules), offsetof(WindFieldParams, polygons), offsetof(WindFieldParams, tubes),
+    offsetof(WindFieldParams, vortices), offsetof(WindFieldParams, radials),  offsetof(WindFieldParams, sourceSinks),
+    offsetof(WindFieldParams, vertices)};
+const size_t BUCKET_STRIDE[SHAPE_TYPE_COUNT + 1] = {
+    sizeof(GpuCircle), sizeof(GpuRect), sizeof(GpuSector), sizeof(GpuCapsule), sizeof(GpuPath),
+    sizeof(GpuPath),   sizeof(GpuFlow), sizeof(GpuFlow),   sizeof(GpuFlow),    sizeof(glm::vec2)};
+
+struct ShapeHandleSlot
+{
+    uint32_t generation = 1;
+    int dense = -1;    // 稠密数组下标，-1为空闲
+    int nextFree = -1; // 空闲槽位链表
+};
+
+// 脏区间[begin, end)
+struct DirtyRange
+{
+    int begin = 0;
+    int end = 0;
+
+    void add(int lo, int hi)
+    {
+        if (end <= begin)
+        {
+            begin = lo;
+            end = hi;
+        }
+        else
+        {
+            begin = std::min(begin, lo);
+            end = std::max(end, hi);
+        }
+    }
+};
+
+struct ShapePoolState
+{
+    std::vector<ShapeHandleSlot> handles;
+    int freeHandle = -1;
+    std::vector<WindShape> shapes;     // 稠密存放，顺序不固定
+    std::vector<int> handleIndex;      // 稠密下标 -> 句柄槽位
+    std::vector<int> packedLayer;      // 稠密下标 -> 所在图层段，或PACKED_NONE/PACKED_DROPPED
+    std::vector<int> packedSlot;       // 稠密下标 -> 桶内下标
+    int bucketOwner[SHAPE_TYPE_COUNT][MAX_SHAPES_PER_TYPE]; // 桶内下标 -> 稠密下标
+    int groupCount[MAX_WIND_LAYERS][SHAPE_TYPE_COUNT] = {}; // 各图层段长度
+    int layerCount = 0;        // 打包时的图层数，0表示下一帧整体重新打包
+    int liveVertices = 0;      // 已打包路径形状占用的顶点数（不含更新后遗留的旧顶点）
+    int droppedShapes = 0;
+    int falloffRadials = 0;    // 已打包且衰减指数不为1的径向风数（决定是否启用衰减变体）
+    bool animationsDirty = true;
+    DirtyRange dirty[PARAM_RING_FRAMES][SHAPE_TYPE_COUNT + 1];
+    size_t uploadBytes = 0;    // 最近一次写切片拷贝的字节数
+};
+ShapePoolState shapePool;
+
+bool hasRadialFalloff(const WindShape& shape)
+{
+    return shape.type == SHAPE_RADIAL && shape.falloff != 1.0f;
+}
+
+// 图层段[l]在类型t的桶中的起始下标；l=layerCount时为桶内形状总数
+int groupStart(const ShapePoolState& pool, int l, int t)
+{
+    int start = 0;
+    for (int g = 0; g < l; g++)
+        start += pool.groupCount[g][t];
+    return start;
+}
+
+// 标记所有切片的脏区间（每个切片各自落后若干帧）
+void markPoolDirty(ShapePoolState& pool, int bucket, int begin, int end)
+{
+    for (DirtyRange* slice : pool.dirty)
+        slice[bucket].add(begin, end);
+}
+
+bool isAnimatedShape(const WindShape& shape)
+{
+    return !shape.keyframes.empty() && isAnimatable(shape.type);
+}
+
+// 桶内搬移一个槽位：打包结果原样拷贝，路径形状的顶点引用不变
+void moveBucketSlot(ShapePoolState& pool, int t, int from, int to)
+{
+    char* bucket = (char*)&windParams + BUCKET_OFFSET[t];
+    memcpy(bucket + to * BUCKET_STRIDE[t], bucket + from * BUCKET_STRIDE[t], BUCKET_STRIDE[t]);
+    int dense = pool.bucketOwner[t][from];
+    pool.bucketOwner[t][to] = dense;
+    pool.packedSlot[dense] = to;
+    if (isAnimatedShape(pool.shapes[dense]))
+        pool.animationsDirty = true;
+    markPoolDirty(pool, t, to, to + 1);
+}
+
+// 顶点缓冲按追加分配，路径形状更新后旧顶点成为空洞；空间不足时按当前形状重新排列
+void compactPoolVertices(ShapePoolState& pool)
+{
+    windParams.vertexCount = 0;
+    for (int t : {SHAPE_POLYGON, SHAPE_SPLINE_TUBE})
+    {
+        int count = groupStart(pool, pool.layerCount, t);
+        for (int slot = 0; slot < count; slot++)
+            packWindShapeAt(pool.shapes[pool.bucketOwner[t][slot]], windParams, slot);
+        markPoolDirty(pool, t, 0, count);
+    }
+    markPoolDirty(pool, VERTEX_BUCKET, 0, windParams.vertexCount);
+}
+
+// 把形状写入它所在的桶位置
+void writePoolShape(ShapePoolState& pool, int dense)
+{
+    const WindShape& shape = pool.shapes[dense];
+    int slot = pool.packedSlot[dense];
+    int firstVertex = windParams.vertexCount;
+    if (firstVertex + shapeVertexCount(shape) > MAX_SHAPE_VERTICES)
+    {
+        compactPoolVertices(pool); // 整理时已按当前内容写入该形状
+        return;
+    }
+    packWindShapeAt(shape, windParams, slot);
+    markPoolDirty(pool, shape.type, slot, slot + 1);
+    if (windParams.vertexCount > firstVertex)
+        markPoolDirty(pool, VERTEX_BUCKET, firstVertex, windParams.vertexCount);
+}
+
+// 放到所在图层段的末尾：其后每个非空图层段把段首形状挪到段尾，逐段向后腾出一个位置
+void placePoolShape(ShapePoolState& pool, int dense)
+{
+    const WindShape& shape = pool.shapes[dense];
+    int t = shape.type;
+    int vertices = shapeVertexCount(shape);
+    int total = groupStart(pool, pool.layerCount, t);
+    if (vertices < 0)
+    {
+        pool.packedLayer[dense] = PACKED_NONE;
+        return;
+    }
+    if (total >= MAX_SHAPES_PER_TYPE || pool.liveVertices + vertices > MAX_SHAPE_VERTICES)
+    {
+        pool.packedLayer[dense] = PACKED_DROPPED;
+        pool.droppedShapes++;
+        return;
+    }
+
+    int l = shapeLayerIndex(shape, pool.layerCount);
+    int hole = total;
+    for (int g = pool.layerCount - 1; g > l; g--)
+    {
+        int start = hole - pool.groupCount[g][t];
+        if (start < hole)
+            moveBucketSlot(pool, t, start, hole);
+        hole = start;
+    }
+    pool.groupCount[l][t]++;
+    pool.packedLayer[dense] = l;
+    pool.packedSlot[dense] = hole;
+    pool.bucketOwner[t][hole] = dense;
+    pool.liveVertices += vertices;
+    pool.falloffRadials += hasRadialFalloff(shape);
+    if (isAnimatedShape(shape))
+        pool.animationsDirty = true;
+    writePoolShape(pool, dense);
+}
+
+// 从图层段中移除：段尾形状填入空位，其后每个非空图层段把段尾形状挪到段首
+void unplacePoolShape(ShapePoolState& pool, int dense)
+{
+    const WindShape& shape = pool.shapes[dense];
+    int l = pool.packedLayer[dense];
+    pool.packedLayer[dense] = PACKED_NONE;
+    if (l == PACKED_DROPPED)
+        pool.droppedShapes--;
+    if (l < 0)
+        return;
+
+    int t = shape.type;
+    int last = groupStart(pool, l + 1, t) - 1;
+    int hole = pool.packedSlot[dense];
+    if (hole != last)
+        moveBucketSlot(pool, t, last, hole);
+    hole = last;
+    pool.groupCount[l][t]--;
+    for (int g = l + 1; g < pool.layerCount; g++)
+    {
+        int count = pool.groupCount[g][t];
+        if (count > 0)
+            moveBucketSlot(pool, t, hole + count, hole);
+        hole += count;
+    }
+    pool.liveVertices -= shapeVertexCount(shape);
+    pool.falloffRadials -= hasRadialFalloff(shape);
+    if (isAnimatedShape(shape))
+        pool.animationsDirty = true;
+}
+
+// 整体重新打包：按图层顺序逐个追加（不产生搬移），所有用到的槽位标脏
+void rebuildShapePool(ShapePoolState& pool, int layerCount)
+{
+    pool.layerCount = layerCount;
+    memset(pool.groupCount, 0, sizeof(pool.groupCount));
+    pool.liveVertices = 0;
+    pool.droppedShapes = 0;
+    pool.falloffRadials = 0;
+    windParams.vertexCount = 0;
+    std::fill(pool.packedLayer.begin(), pool.packedLayer.end(), PACKED_NONE);
+    for (int l = 0; l < layerCount; l++)
+    {
+        for (int dense = 0; dense < (int)pool.shapes.size(); dense++)
+        {
+            if (shapeLayerIndex(pool.shapes[dense], layerCount) == l)
+                placePoolShape(pool, dense);
+        }
+    }
+    pool.animationsDirty = true;
+}
+
+int findPoolShape(const ShapePoolState& pool, WindShapeId id)
+{
+    uint32_t index = id & SHAPE_HANDLE_INDEX_MASK;
+    if (index >= pool.handles.size())
+        return -1;
+    const ShapeHandleSlot& slot = pool.handles[index];
+    return slot.dense >= 0 && slot.generation == id >> SHAPE_HANDLE_INDEX_BITS ? slot.dense : -1;
+}
+
+WindShapeId addPoolShape(ShapePoolState& pool, const WindShape& shape)
+{
+    int index = pool.freeHandle;
+    if (index >= 0)
+    {
+        pool.freeHandle = pool.handles[index].nextFree;
+    }
+    else
+    {
+        if (pool.handles.size() > SHAPE_HANDLE_INDEX_MASK)
+            return 0;
+        index = (int)pool.handles.size();
+        pool.handles.emplace_back();
+    }
+    ShapeHandleSlot& slot = pool.handles[index];
+    slot.dense = (int)pool.shapes.size();
+    slot.nextFree = -1;
+    pool.shapes.push_back(shape);
+    pool.handleIndex.push_back(index);
+    pool.packedLayer.push_back(PACKED_NONE);
+    pool.packedSlot.push_back(0);
+    if (pool.layerCount > 0)
+        placePoolShape(pool, slot.dense);
+    return slot.generation << SHAPE_HANDLE_INDEX_BITS | (uint32_t)index;
+}
+
+bool updatePoolShape(ShapePoolState& pool, WindShapeId id, const WindShape& shape)
+{
+    int dense = findPoolShape(pool, id);
+    if (dense < 0)
+        return false;
+    WindShape& target = pool.shapes[dense];
+    if (pool.layerCount == 0)
+    {
+        target = shape;
+        return true;
+    }
+
+    // 类型、图层段和顶点数不变时原位重写，否则移出后重新放入
+    int layer = pool.packedLayer[dense];
+    bool inPlace = layer >= 0 && shape.type == target.type && shapeLayerIndex(shape, pool.layerCount) == layer &&
+                   shapeVertexCount(shape) == shapeVertexCount(target);
+    if (isAnimatedShape(shape) || isAnimatedShape(target))
+        pool.animationsDirty = true;
+    if (inPlace)
+    {
+        pool.falloffRadials += (int)hasRadialFalloff(shape) - (int)hasRadialFalloff(target);
+        target = shape;
+        writePoolShape(pool, dense);
+    }
+    else
+    {
+        unplacePoolShape(pool, dense);
+        target = shape;
+        placePoolShape(pool, dense);
+    }
+    return true;
+}
+
+bool removePoolShape(ShapePoolState& pool, WindShapeId id)
+{
+    int dense = findPoolShape(pool, id);
+    if (dense < 0)
+        return false;
+    bool freedSlot = pool.packedLayer[dense] >= 0;
+    if (pool.layerCount > 0)
+        unplacePoolShape(pool, dense);
+
+    // 稠密数组与末尾交换后弹出，修正被挪动形状的句柄与桶反查
+    int last = (int)pool.shapes.size() - 1;
+    if (dense != last)
+    {
+        pool.shapes[dense] = std::move(pool.shapes[last]);
+        pool.handleIndex[dense] = pool.handleIndex[last];
+        pool.packedLayer[dense] = pool.packedLayer[last];
+        pool.packedSlot[dense] = pool.packedSlot[last];
+        pool.handles[pool.handleIndex[dense]].dense = dense;
+        if (pool.packedLayer[dense] >= 0)
+            pool.bucketOwner[pool.shapes[dense].type][pool.packedSlot[dense]] = dense;
+    }
+    pool.shapes.pop_back();
+    pool.handleIndex.pop_back();
+    pool.packedLayer.pop_back();
+    pool.packedSlot.pop_back();
+
+    int index = (int)(id & SHAPE_HANDLE_INDEX_MASK);
+    ShapeHandleSlot& slot = pool.handles[index];
+    slot.dense = -1;
+    slot.generation = slot.generation == SHAPE_HANDLE_MAX_GENERATION ? 1 : slot.generation + 1;
+    slot.nextFree = pool.freeHandle;
+    pool.freeHandle = index;
+
+    // 有形状因容量不足未打包时，腾出空位后下一帧整体重新打包
+    if (freedSlot && pool.droppedShapes > 0)
+        pool.layerCount = 0;
+    return true;
+}
+
+// 每帧写切片前调用：图层数变化时重新打包，再由各图层段生成头部计数与图层表
+void syncShapePool(ShapePoolState& pool, const std::vector<WindLayer>& layers, WindFieldParams& params)
+{
+    int layerCount = packedLayerCount(layers);
+    if (pool.layerCount != layerCount)
+        rebuildShapePool(pool, layerCount);
+
+    params.layerCount = layerCount;
+    for (int t = 0; t < SHAPE_TYPE_COUNT; t++)
+        *bucketCount(params, (ShapeType)t) = groupStart(pool, layerCount, t);
+    const WindLayer defaultLayer;
+    for (int l = 0; l < layerCount; l++)
+    {
+        const WindLayer& layer = l < (int)layers.size() ? layers[l] : defaultLayer;
+        GpuLayer& gpuLayer = params.layers[l];
+        gpuLayer.blendMode = layer.blend;
+        gpuLayer.enabled = layer.enabled ? 1 : 0;
+        gpuLayer.useMask = layer.useMask ? 1 : 0;
+        gpuLayer.invertMask = layer.invertMask ? 1 : 0;
+        gpuLayer.maskMin = layer.maskMin;
+        gpuLayer.maskMax = layer.maskMax;
+        for (int t = 0; t < SHAPE_TYPE_COUNT; t++)
+        {
+            gpuLayer.firstShape[t] = groupStart(pool, l, t);
+            gpuLayer.shapeCount[t] = pool.groupCount[l][t];
+        }
+    }
+}
+
+// 把参数写入切片：头部每帧写入，各桶只拷贝该切片上次写入后变化的槽位，返回拷贝的字节数
+size_t writeParamSlice(WindFieldParams* slice, const WindFieldParams& params, DirtyRange* dirty)
+{
+    const size_t headerSize = offsetof(WindFieldParams, circles);
+    memcpy(slice, &params, headerSize);
+    size_t bytes = headerSize;
+    for (int b = 0; b <= VERTEX_BUCKET; b++)
+    {
+        DirtyRange& range = dirty[b];
+        if (range.end > range.begin)
+        {
+            size_t offset = BUCKET_OFFSET[b] + range.begin * BUCKET_STRIDE[b];
+            size_t size = (range.end - range.begin) * BUCKET_STRIDE[b];
+            memcpy((char*)slice + offset, (const char*)&params + offset, size);
+            bytes += size;
+        }
+        range = DirtyRange();
+    }
+    return bytes;
+}
+
+// 将当前切片绑定到binding=0，供本帧的dispatch读取
+void bindParamSlice()
+{
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, paramBuffer, paramRingIndex * paramSliceSize, sizeof(WindFieldParams));
+}
+
+// 本帧命令提交后插入fence，并切换到下一个切片
+void releaseParamSlice()
+{
+    paramFences[paramRingIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    paramRingIndex = (paramRingIndex + 1) % PARAM_RING_FRAMES;
+}
+
+// 释放参数环形缓冲
+void destroyParamBuffer()
+{
+    for (GLsync& fence : paramFences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, paramBuffer);
+    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glDeleteBuffers(1, &paramBuffer);
+    paramRingPtr = nullptr;
+    paramRingIndex = 0;
+}
+
+// ===================== 初始化Compute Shader =====================
+// 版本行单独拼接，便于在其后注入#define
+const char* csVersionSource = "#version 430 core\n";
+
+// 稀疏虚拟风场的分页参数
+const int WIND_PAGE_SIZE = 64;                               // 每页texel边长（4x4个tile）
+const int WIND_PAGE_TILES = WIND_PAGE_SIZE / TILE_SIZE;      // 每页每轴tile数
+const int WIND_ATLAS_PAGES_X = 16;                           // 物理图集每行页数（1024texel宽），行数按WindFieldConfig::atlasPages分配
+
+// 稀疏变体：在公共部分之前注入分页参数
+std::string sparseDefines()
+{
+    return "#define WIND_SPARSE\n#define WIND_PAGE_SIZE " + std::to_string(WIND_PAGE_SIZE) +
+           "\n#define WIND_PAGE_TILES " + std::to_string(WIND_PAGE_TILES) + "\n#define WIND_ATLAS_PAGES_X " +
+           std::to_string(WIND_ATLAS_PAGES_X) + "\n";
+}
+
+// 公共部分：形状结构与参数SSBO（风场Shader与tile占用pass共用）
+const char* csCommonSource = R"(
+        // tile列表按二维间接调度：每行TILE_DISPATCH_WIDTH个工作组（GL保证的X方向最小上限），
+        // tile数超过它时增加行数，不受驱动的X方向工作组数限制
+        #define TILE_DISPATCH_WIDTH 65535u
+
+        // 分桶形状结构（与CPU端struct对齐，std140下均为32字节）
+        struct GpuCircle {
+            vec2 pos;           // 中心位置
+            float radiusSq;     // 半径平方
+            float radius;       // 半径（抗锯齿SDF用）
+            vec2 windVec;       // 风向×风速
+            vec2 padding1;
+        };
+
+        struct GpuRect {
+            vec2 pos;           // 中心位置
+            vec2 halfSize;      // 半宽/半高
+            vec2 axis;          // (cos, sin)旋转角
+            vec2 windVec;       // 风向×风速
+        };
+
+        struct GpuSector {
+            vec2 pos;           // 中心位置
+            float radiusSq;     // 半径平方
+            float cosHalfRange; // cos(角度范围/2)
+            vec2 centerDir;     // 角平分线方向
+            vec2 windVec;       // 风向×风速
+        };
+
+        struct GpuCapsule {
+            vec2 a;             // 线段端点
+            vec2 b;
+            float radius;       // 半径
+            float padding0;
+            vec2 windVec;       // 风向×风速
+        };
+
+        struct GpuPath {
+            vec2 center;        // 包围盒中心
+            vec2 extent;        // 包围盒半尺寸（已含半径）
+            int firstVertex;    // 顶点缓冲起始下标
+            int vertexCount;    // 顶点数
+            float radius;       // 管道半径（多边形为0）
+            float padding0;
+            vec2 windVec;       // 风向×风速
+            vec2 padding1;
+        };
+
+        struct GpuFlow {
+            vec2 pos;           // 中心位置
+            float radius;       // 作用半径
+            float coreRadius;   // 核半径
+            float strength;     // 风速，带符号
+            float falloff;      // 径向风衰减指数
+            vec2 padding0;
+        };
+
+        // 形状类型（与CPU端ShapeType一致，用作图层区间下标）
+        const int SHAPE_CIRCLE = 0;
+        const int SHAPE_RECT = 1;
+        const int SHAPE_SECTOR = 2;
+        const int SHAPE_CAPSULE = 3;
+        const int SHAPE_POLYGON = 4;
+        const int SHAPE_SPLINE_TUBE = 5;
+        const int SHAPE_VORTEX = 6;
+        const int SHAPE_RADIAL = 7;
+        const int SHAPE_SOURCE_SINK = 8;
+
+        // 图层混合模式
+        const int BLEND_ADD = 0;
+        const int BLEND_MAX_MAGNITUDE = 1;
+        const int BLEND_OVERRIDE = 2;
+        const int BLEND_MULTIPLY = 3;
+
+        struct GpuLayer {
+            int blendMode;
+            int enabled;
+            int useMask;
+            int invertMask;
+            vec2 maskMin;       // 遮罩区域（世界坐标AABB）
+            vec2 maskMax;
+            int firstShape[9];  // 各桶中本层形状的起始下标
+            int padding0[3];
+            int shapeCount[9];
+            int padding1[3];
+        };
+
+        // 风场全局参数SSBO
+        // 默认只读；需要写参数的pass（关键帧动画）在拼接前定义为空
+        #ifndef PARAMS_ACCESS
+        #define PARAMS_ACCESS readonly
+        #endif
+
+        layout(std430, binding = 0) PARAMS_ACCESS buffer WindFieldParams {
+            int circleCount;    // 各桶形状数量
+            int rectCount;
+            int sectorCount;
+            int rtWidth;        // RT宽度
+            int rtHeight;       // RT高度
+            float texelSize;    // 每个texel对应的世界单位
+            vec2 worldOrigin;   // RT左下角texel的世界坐标
+            int aaMode;         // 抗锯齿模式
+            int aaSamples;      // 超采样每轴采样数
+            int capsuleCount;
+            int polygonCount;
+            int tubeCount;
+            int vertexCount;    // 顶点缓冲已用数量
+            int vortexCount;
+            int radialCount;
+            int sourceSinkCount;
+            int layerCount;     // 图层数
+            int padding1;
+            int padding2;
+            GpuLayer layers[8];
+            GpuCircle circles[128];
+            GpuRect rects[128];
+            GpuSector sectors[128];
+            GpuCapsule capsules[128];
+            GpuPath polygons[128];
+            GpuPath tubes[128];
+            GpuFlow vortices[128];
+            GpuFlow radials[128];
+            GpuFlow sourceSinks[128];
+            vec2 vertices[4096];
+        } params;
+
+        // 稀疏模式的驻留页列表：x=虚拟页坐标(x | y << 16)，y=物理槽位
+        #ifdef WIND_SPARSE
+        layout(std430, binding = 8) readonly buffer WindPages {
+            uint pageCount;
+            uint padding0;
+            uint padding1;
+            uint padding2;
+            uvec2 pages[];
+        } windPages;
+        #endif
+
+        // 第l层在某个桶中的下标区间：for (LAYER_RANGE(l, SHAPE_CIRCLE)) {...}
+        #define LAYER_RANGE(l, type) int i = params.layers[l].firstShape[type]; \
+            i < params.layers[l].firstShape[type] + params.layers[l].shapeCount[type]; i++
+
+        // 到图层遮罩区域的有符号距离（生效区域内为负），无遮罩时恒在区域内
+        float layerMaskDistance(int l, vec2 p) {
+            if (params.layers[l].useMask == 0) return -1e30;
+            vec2 center = (params.layers[l].maskMin + params.layers[l].maskMax) * 0.5;
+            vec2 q = abs(p - center) - (params.layers[l].maskMax - params.layers[l].maskMin) * 0.5;
+            float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0);
+            return params.layers[l].invertMask != 0 ? -d : d;
+        }
+
+    )";
+
+// 风场Shader：按场景内容注入#define特化出变体（见"风场Shader变体"），用不到的形状循环与分支在编译期去掉
+const char* csSource = R"(
+        // 输出RT：RG=风向向量xy，BA=预留（0,0）
+        layout(rgba32f, binding = 1) writeonly uniform image2D windRT;
+
+        // 被占用tile列表（由占用pass生成）
+        layout(std430, binding = 2) readonly buffer TileList {
+            uint dispatchX;
+            uint dispatchY;
+            uint dispatchZ;
+            uint tileCount;
+            uint tiles[];       // 打包的tile：x | (y << 12) | (起始图层 << 24)；稀疏模式低24位为 页内tile | (页下标 << 6)
+        } tileList;
+
+        // 线程布局：每个工作组对应一个被占用的16x16 tile，每线程处理WIND_PIXELS_X×WIND_PIXELS_Y个像素，
+        // 同一形状只读一次、对这几个像素复用；工作组尺寸为16/每线程像素数（layout只接受字面量，由CPU端注入）
+        #ifndef WIND_GROUP_X
+        #define WIND_GROUP_X 16
+        #define WIND_GROUP_Y 16
+        #endif
+        #define WIND_PIXELS_X (16 / WIND_GROUP_X)
+        #define WIND_PIXELS_Y (16 / WIND_GROUP_Y)
+        #define WIND_PIXEL_COUNT (WIND_PIXELS_X * WIND_PIXELS_Y)
+        layout(local_size_x = WIND_GROUP_X, local_size_y = WIND_GROUP_Y) in;
+
+        // 线程内第p个像素在tile内的偏移：按工作组尺寸交错，同一轮各线程写相邻像素
+        ivec2 pixelOffset(int p) {
+            return ivec2(gl_LocalInvocationID.xy) + ivec2(p % WIND_PIXELS_X * WIND_GROUP_X, p / WIND_PIXELS_X * WIND_GROUP_Y);
+        }
+
+        // 对本线程在当前图层遮罩内的像素逐个求值：PIXEL_LOOP { ... pixelPos[p] ... }
+        #define PIXEL_LOOP for (int p = 0; p < WIND_PIXEL_COUNT; p++) if (mask[p] > 0.0)
+
+        // 开销调试：每像素重叠形状数写入R32UI纹理，形状测试总数累加到全局计数
+        #ifdef WIND_DEBUG_COST
+        layout(r32ui, binding = 3) writeonly uniform uimage2D overlapRT;
+        layout(std430, binding = 5) buffer CostCounter {
+            uint totalShapeTests;
+        } costCounter;
+        uint shapeTestCount = 0u;
+        uint overlapCount[WIND_PIXEL_COUNT];
+        #define COUNT_SHAPE(coverage) { shapeTestCount++; if ((coverage) > 0.0) overlapCount[p]++; }
+        #else
+        #define COUNT_SHAPE(coverage)
+        #endif
+
+        // 共享内存分块暂存：工作组内前WIND_STAGE_SIZE个线程各取一个形状写入shared数组，
+        // barrier后全组线程都从共享内存读，每个形状每组只取一次SSBO（各线程布局的工作组都不少于64个线程）。
+        // barrier要求组内控制流一致，因此超出RT或在遮罩外的线程不提前退出，只跳过求值
+        #ifdef WIND_SHARED_STAGING
+        #define WIND_STAGE_SIZE 64
+        #ifdef WIND_USE_CIRCLE
+        shared GpuCircle stagedCircles[WIND_STAGE_SIZE];
+        #endif
+        #ifdef WIND_USE_RECT
+        shared GpuRect stagedRects[WIND_STAGE_SIZE];
+        #endif
+        #ifdef WIND_USE_SECTOR
+        shared GpuSector stagedSectors[WIND_STAGE_SIZE];
+        #endif
+        #ifdef WIND_USE_CAPSULE
+        shared GpuCapsule stagedCapsules[WIND_STAGE_SIZE];
+        #endif
+        #if defined(WIND_USE_POLYGON) || defined(WIND_USE_SPLINE_TUBE)
+        shared GpuPath stagedPaths[WIND_STAGE_SIZE];
+        #endif
+        #if defined(WIND_USE_VORTEX) || defined(WIND_USE_RADIAL) || defined(WIND_USE_SOURCE_SINK)
+        shared GpuFlow stagedFlows[WIND_STAGE_SIZE];
+        #endif
+
+        // SHAPE_LOOP(l, 类型, 参数数组, 暂存数组) { ... SHAPE_AT(参数数组, 暂存数组) ... } SHAPE_LOOP_END
+        #define SHAPE_LOOP(l, type, array, stage) \
+            for (int base = params.layers[l].firstShape[type], end = base + params.layers[l].shapeCount[type]; \
+                 base < end; base += WIND_STAGE_SIZE) { \
+                int n = min(end - base, WIND_STAGE_SIZE); \
+                if (int(gl_LocalInvocationIndex) < n) stage[gl_LocalInvocationIndex] = params.array[base + int(gl_LocalInvocationIndex)]; \
+                memoryBarrierShared(); \
+                barrier(); \
+                for (int k = 0; pixelsActive && k < n; k++)
+        #define SHAPE_AT(array, stage) stage[k]
+        #define SHAPE_LOOP_END barrier(); }
+        #else
+        #define SHAPE_LOOP(l, type, array, stage) for (LAYER_RANGE(l, type))
+        #define SHAPE_AT(array, stage) params.array[i]
+        #define SHAPE_LOOP_END
+        #endif
+
+        // ===================== 工具函数 =====================
+        // 判定像素是否在圆形内
+        bool isInCircle(vec2 pixelPos, GpuCircle shape) {
+            vec2 delta = pixelPos - shape.pos;
+            return dot(delta, delta) <= shape.radiusSq;
+        }
+
+        // 判定像素是否在旋转矩形内（反向旋转到矩形局部坐标）
+        bool isInRect(vec2 pixelPos, GpuRect shape) {
+            vec2 delta = pixelPos - shape.pos;
+            vec2 local = vec2(dot(delta, shape.axis), dot(delta, vec2(-shape.axis.y, shape.axis.x)));
+            return all(lessThanEqual(abs(local), shape.halfSize));
+        }
+
+        // 判定像素是否在扇形内：半径内且与角平分线夹角不超过半角
+        bool isInSector(vec2 pixelPos, GpuSector shape) {
+            vec2 delta = pixelPos - shape.pos;
+            float distSq = dot(delta, delta);
+            if (distSq > shape.radiusSq) return false; // 超出半径
+            return dot(delta, shape.centerDir) >= shape.cosHalfRange * sqrt(distSq);
+        }
+
+        // ===================== 抗锯齿覆盖率 =====================
+        const int AA_NONE = 0;
+        const int AA_ANALYTIC = 1;
+        const int AA_SUPERSAMPLE = 2;
+
+        // 有符号距离（世界单位，内部为负）
+        float sdCircle(vec2 pixelPos, GpuCircle shape) {
+            return length(pixelPos - shape.pos) - shape.radius;
+        }
+
+        float sdRect(vec2 pixelPos, GpuRect shape) {
+            vec2 delta = pixelPos - shape.pos;
+            vec2 local = vec2(dot(delta, shape.axis), dot(delta, vec2(-shape.axis.y, shape.axis.x)));
+            vec2 q = abs(local) - shape.halfSize;
+            return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0);
+        }
+
+        // 扇形SDF：转到以角平分线为+y的局部坐标，c=(sin半角, cos半角)
+        float sdSector(vec2 pixelPos, GpuSector shape) {
+            vec2 delta = pixelPos - shape.pos;
+            vec2 p = vec2(abs(dot(delta, vec2(shape.centerDir.y, -shape.centerDir.x))), dot(delta, shape.centerDir));
+            vec2 c = vec2(sqrt(max(1.0 - shape.cosHalfRange * shape.cosHalfRange, 0.0)), shape.cosHalfRange);
+            float r = sqrt(shape.radiusSq);
+            float l = length(p) - r;
+            float m = length(p - c * clamp(dot(p, c), 0.0, r));
+            return max(l, m * sign(c.y * p.x - c.x * p.y));
+        }
+
+        // 点到线段ab的距离
+        float segmentDistance(vec2 p, vec2 a, vec2 b) {
+            vec2 pa = p - a;
+            vec2 ba = b - a;
+            float h = clamp(dot(pa, ba) / max(dot(ba, ba), 1e-8), 0.0, 1.0);
+            return length(pa - ba * h);
+        }
+
+        float sdCapsule(vec2 pixelPos, GpuCapsule shape) {
+            return segmentDistance(pixelPos, shape.a, shape.b) - shape.radius;
+        }
+
+        // 多边形SDF：到各边最短距离，交叉数奇偶判定内外
+        float sdPolygon(vec2 pixelPos, GpuPath shape) {
+            int first = shape.firstVertex;
+            int count = shape.vertexCount;
+            vec2 d0 = pixelPos - params.vertices[first];
+            float d = dot(d0, d0);
+            float s = 1.0;
+            for (int i = 0, j = count - 1; i < count; j = i, i++) {
+                vec2 vi = params.vertices[first + i];
+                vec2 vj = params.vertices[first + j];
+                vec2 e = vj - vi;
+                vec2 w = pixelPos - vi;
+                vec2 b = w - e * clamp(dot(w, e) / max(dot(e, e), 1e-8), 0.0, 1.0);
+                d = min(d, dot(b, b));
+                bvec3 c = bvec3(pixelPos.y >= vi.y, pixelPos.y < vj.y, e.x * w.y > e.y * w.x);
+                if (all(c) || all(not(c))) s = -s;
+            }
+            return s * sqrt(d);
+        }
+
+        // 样条管道SDF：到折线最短距离减半径
+        float sdTube(vec2 pixelPos, GpuPath shape) {
+            float d = 1e30;
+            for (int i = 0; i + 1 < shape.vertexCount; i++) {
+                int v = shape.firstVertex + i;
+                d = min(d, segmentDistance(pixelPos, params.vertices[v], params.vertices[v + 1]));
+            }
+            return d - shape.radius;
+        }
+
+        // 包围盒外的像素直接跳过顶点循环
+        bool outsideBounds(vec2 pixelPos, GpuPath shape) {
+            return any(greaterThan(abs(pixelPos - shape.center), shape.extent + params.texelSize));
+        }
+
+        // SDF转覆盖率：距离除以像素覆盖的世界尺寸
+        float sdfCoverage(float sd) {
+            return clamp(0.5 - sd / params.texelSize, 0.0, 1.0);
+        }
+
+        // 超采样第i个采样点相对texel中心的偏移（每轴n个均匀分布）
+        vec2 sampleOffset(int i, int n) {
+            vec2 cell = vec2(i % n, i / n);
+            return ((cell + 0.5) / float(n) - 0.5) * params.texelSize;
+        }
+
+        // 抗锯齿模式由变体编译期确定，只保留一条路径
+        float circleCoverage(vec2 pixelPos, GpuCircle shape) {
+            if (WIND_AA_MODE == AA_ANALYTIC) return sdfCoverage(sdCircle(pixelPos, shape));
+            if (WIND_AA_MODE == AA_SUPERSAMPLE) {
+                int n = params.aaSamples;
+                int hits = 0;
+                for (int i = 0; i < n * n; i++) hits += int(isInCircle(pixelPos + sampleOffset(i, n), shape));
+                return float(hits) / float(n * n);
+            }
+            return isInCircle(pixelPos, shape) ? 1.0 : 0.0;
+        }
+
+        float rectCoverage(vec2 pixelPos, GpuRect shape) {
+            if (WIND_AA_MODE == AA_ANALYTIC) return sdfCoverage(sdRect(pixelPos, shape));
+            if (WIND_AA_MODE == AA_SUPERSAMPLE) {
+                int n = params.aaSamples;
+                int hits = 0;
+                for (int i = 0; i < n * n; i++) hits += int(isInRect(pixelPos + sampleOffset(i, n), shape));
+                return float(hits) / float(n * n);
+            }
+            return isInRect(pixelPos, shape) ? 1.0 : 0.0;
+        }
+
+        // SDF形状的覆盖率：二值模式取sd<=0，超采样模式逐采样点求sd
+        float capsuleCoverage(vec2 pixelPos, GpuCapsule shape) {
+            if (WIND_AA_MODE == AA_ANALYTIC) return sdfCoverage(sdCapsule(pixelPos, shape));
+            if (WIND_AA_MODE == AA_SUPERSAMPLE) {
+                int n = params.aaSamples;
+                int hits = 0;
+                for (int i = 0; i < n * n; i++) hits += int(sdCapsule(pixelPos + sampleOffset(i, n), shape) <= 0.0);
+                return float(hits) / float(n * n);
+            }
+            return sdCapsule(pixelPos, shape) <= 0.0 ? 1.0 : 0.0;
+        }
+
+        float polygonCoverage(vec2 pixelPos, GpuPath shape) {
+            if (outsideBounds(pixelPos, shape)) return 0.0;
+            if (WIND_AA_MODE == AA_ANALYTIC) return sdfCoverage(sdPolygon(pixelPos, shape));
+            if (WIND_AA_MODE == AA_SUPERSAMPLE) {
+                int n = params.aaSamples;
+                int hits = 0;
+                for (int i = 0; i < n * n; i++) hits += int(sdPolygon(pixelPos + sampleOffset(i, n), shape) <= 0.0);
+                return float(hits) / float(n * n);
+            }
+            return sdPolygon(pixelPos, shape) <= 0.0 ? 1.0 : 0.0;
+        }
+
+        float tubeCoverage(vec2 pixelPos, GpuPath shape) {
+            if (outsideBounds(pixelPos, shape)) return 0.0;
+            if (WIND_AA_MODE == AA_ANALYTIC) return sdfCoverage(sdTube(pixelPos, shape));
+            if (WIND_AA_MODE == AA_SUPERSAMPLE) {
+                int n = params.aaSamples;
+                int hits = 0;
+                for (int i = 0; i < n * n; i++) hits += int(sdTube(pixelPos + sampleOffset(i, n), shape) <= 0.0);
+                return float(hits) / float(n * n);
+            }
+            return sdTube(pixelPos, shape) <= 0.0 ? 1.0 : 0.0;
+        }
+
+        // 区域风的作用范围为圆形
+        float flowCoverage(vec2 pixelPos, GpuFlow shape) {
+            vec2 delta = pixelPos - shape.pos;
+            if (WIND_AA_MODE == AA_ANALYTIC) return sdfCoverage(length(delta) - shape.radius);
+            if (WIND_AA_MODE == AA_SUPERSAMPLE) {
+                int n = params.aaSamples;
+                int hits = 0;
+                for (int i = 0; i < n * n; i++) {
+                    vec2 d = delta + sampleOffset(i, n);
+                    hits += int(dot(d, d) <= shape.radius * shape.radius);
+                }
+                return float(hits) / float(n * n);
+            }
+            return dot(delta, delta) <= shape.radius * shape.radius ? 1.0 : 0.0;
+        }
+
+        float sectorCoverage(vec2 pixelPos, GpuSector shape) {
+            if (WIND_AA_MODE == AA_ANALYTIC) return sdfCoverage(sdSector(pixelPos, shape));
+            if (WIND_AA_MODE == AA_SUPERSAMPLE) {
+                int n = params.aaSamples;
+                int hits = 0;
+                for (int i = 0; i < n * n; i++) hits += int(isInSector(pixelPos + sampleOffset(i, n), shape));
+                return float(hits) / float(n * n);
+            }
+            return isInSector(pixelPos, shape) ? 1.0 : 0.0;
+        }
+
+        // ===================== 按像素计算风向的形状 =====================
+        // 核内线性增长、核外按core/r衰减（Rankine涡/正则化点源的速度剖面）
+        float coreProfile(float r, GpuFlow shape) {
+            return r < shape.coreRadius ? r / shape.coreRadius : shape.coreRadius / r;
+        }
+
+        // 涡旋：切向风，strength>0逆时针
+        vec2 vortexWindVec(vec2 pixelPos, GpuFlow shape) {
+            vec2 delta = pixelPos - shape.pos;
+            float r = length(delta);
+            if (r < 1e-4) return vec2(0.0);
+            return vec2(-delta.y, delta.x) / r * (shape.strength * coreProfile(r, shape));
+        }
+
+        // 径向：strength>0爆炸（向外），<0内爆，风速按(1-r/R)^falloff衰减
+        vec2 radialWindVec(vec2 pixelPos, GpuFlow shape) {
+            vec2 delta = pixelPos - shape.pos;
+            float r = length(delta);
+            if (r < 1e-4) return vec2(0.0);
+            float t = clamp(1.0 - r / shape.radius, 0.0, 1.0);
+            #ifdef WIND_RADIAL_FALLOFF
+            t = pow(t, shape.falloff);
+            #endif
+            return delta / r * (shape.strength * t);
+        }
+
+        // 源汇：strength>0为源（向外），<0为汇，核外按1/r衰减
+        vec2 sourceSinkWindVec(vec2 pixelPos, GpuFlow shape) {
+            vec2 delta = pixelPos - shape.pos;
+            float r = length(delta);
+            if (r < 1e-4) return vec2(0.0);
+            return delta / r * (shape.strength * coreProfile(r, shape));
+        }
+
+        // ===================== 图层合成 =====================
+        // 层内累加：风向量、风速幅值（乘模式用）、覆盖率
+        struct LayerSample {
+            vec2 windVec;
+            float gain;
+            float coverage;
+        };
+
+        void accumulate(inout LayerSample s, vec2 windVec, float c) {
+            if (c <= 0.0) return;
+            s.windVec += windVec * c;
+            s.gain += length(windVec) * c;
+            s.coverage += c;
+        }
+
+        // 遮罩覆盖率与形状边缘使用同一抗锯齿方式
+        float maskCoverage(float sd) {
+            return WIND_AA_MODE == AA_NONE ? (sd <= 0.0 ? 1.0 : 0.0) : sdfCoverage(sd);
+        }
+
+        // 把本层结果合成到下层结果上，mask为遮罩覆盖率
+        vec2 blendLayer(vec2 below, int mode, LayerSample s, float mask) {
+            vec2 v = s.windVec * mask;
+            float a = min(s.coverage, 1.0) * mask;
+            if (mode == BLEND_MAX_MAGNITUDE) return dot(v, v) > dot(below, below) ? v : below;
+            if (mode == BLEND_OVERRIDE) return below * (1.0 - a) + v;
+            if (mode == BLEND_MULTIPLY) return below * (1.0 - a + s.gain * mask);
+            return below + v;
+        }
+
+        // ===================== 主逻辑 =====================
+        void main() {
+            // 由tile列表得到本工作组tile左下角的像素坐标；最后一行超出tile数的工作组整组退出
+            uint tileIndex = gl_WorkGroupID.y * TILE_DISPATCH_WIDTH + gl_WorkGroupID.x;
+            if (tileIndex >= tileList.tileCount) {
+                return;
+            }
+            uint packedTile = tileList.tiles[tileIndex];
+            // 完全覆盖本tile的最上层覆盖图层由占用pass给出，其下各层不影响结果，整个工作组跳过
+            int startLayer = int(packedTile >> 24);
+            #ifdef WIND_SPARSE
+            // 稀疏模式：pixelBase为虚拟texel坐标，storeBase为图集中的物理texel坐标
+            uint localTile = packedTile & 63u;
+            uvec2 page = windPages.pages[(packedTile >> 6) & 0x3FFFFu];
+            ivec2 local = ivec2(localTile % uint(WIND_PAGE_TILES), localTile / uint(WIND_PAGE_TILES)) * 16;
+            ivec2 pixelBase = ivec2(page.x & 0xFFFFu, page.x >> 16) * WIND_PAGE_SIZE + local;
+            ivec2 storeBase = ivec2(page.y % uint(WIND_ATLAS_PAGES_X), page.y / uint(WIND_ATLAS_PAGES_X)) * WIND_PAGE_SIZE + local;
+            #else
+            ivec2 tileCoord = ivec2(packedTile & 0xFFFu, (packedTile >> 12) & 0xFFFu);
+            ivec2 pixelBase = tileCoord * 16;
+            ivec2 storeBase = pixelBase;
+            #endif
+
+            // 本线程各像素对应的世界坐标；超出RT范围的像素不求值也不写出
+            vec2 pixelPos[WIND_PIXEL_COUNT];
+            bool inside[WIND_PIXEL_COUNT];
+            vec2 totalWindVec[WIND_PIXEL_COUNT];
+            bool anyInside = false;
+            for (int p = 0; p < WIND_PIXEL_COUNT; p++) {
+                ivec2 pixelCoord = pixelBase + pixelOffset(p);
+                pixelPos[p] = params.worldOrigin + vec2(pixelCoord) * params.texelSize;
+                inside[p] = pixelCoord.x < params.rtWidth && pixelCoord.y < params.rtHeight;
+                anyInside = anyInside || inside[p];
+                totalWindVec[p] = vec2(0.0);
+                #ifdef WIND_DEBUG_COST
+                overlapCount[p] = 0u;
+                #endif
+            }
+            // 全部超出RT则返回（分块暂存时仍要参与组内的加载与barrier）
+            #ifndef WIND_SHARED_STAGING
+            if (!anyInside) {
+                return;
+            }
+            #endif
+
+            // 逐层求值并按混合模式合成，关闭的图层和遮罩外的像素跳过该层全部形状
+            for (int l = startLayer; l < params.layerCount; l++) {
+                if (params.layers[l].enabled == 0) continue;
+                float mask[WIND_PIXEL_COUNT];
+                LayerSample s[WIND_PIXEL_COUNT];
+                bool pixelsActive = false;
+                for (int p = 0; p < WIND_PIXEL_COUNT; p++) {
+                    #ifdef WIND_LAYER_MASKS
+                    mask[p] = inside[p] ? maskCoverage(layerMaskDistance(l, pixelPos[p])) : 0.0;
+                    #else
+                    mask[p] = inside[p] ? 1.0 : 0.0;
+                    #endif
+                    pixelsActive = pixelsActive || mask[p] > 0.0;
+                    s[p] = LayerSample(vec2(0.0), 0.0, 0.0);
+                }
+                #ifndef WIND_SHARED_STAGING
+                if (!pixelsActive) continue;
+                #endif
+
+                // 每类形状一个循环，按覆盖率加权累加；场景中没有的形状类型整个循环不编译
+                #ifdef WIND_USE_CIRCLE
+                SHAPE_LOOP(l, SHAPE_CIRCLE, circles, stagedCircles) {
+                    GpuCircle shape = SHAPE_AT(circles, stagedCircles);
+                    PIXEL_LOOP {
+                        float c = circleCoverage(pixelPos[p], shape);
+                        accumulate(s[p], shape.windVec, c);
+                        COUNT_SHAPE(c);
+                    }
+                } SHAPE_LOOP_END
+                #endif
+                #ifdef WIND_USE_RECT
+                SHAPE_LOOP(l, SHAPE_RECT, rects, stagedRects) {
+                    GpuRect shape = SHAPE_AT(rects, stagedRects);
+                    PIXEL_LOOP {
+                        float c = rectCoverage(pixelPos[p], shape);
+                        accumulate(s[p], shape.windVec, c);
+                        COUNT_SHAPE(c);
+                    }
+                } SHAPE_LOOP_END
+                #endif
+                #ifdef WIND_USE_SECTOR
+                SHAPE_LOOP(l, SHAPE_SECTOR, sectors, stagedSectors) {
+                    GpuSector shape = SHAPE_AT(sectors, stagedSectors);
+                    PIXEL_LOOP {
+                        float c = sectorCoverage(pixelPos[p], shape);
+                        accumulate(s[p], shape.windVec, c);
+                        COUNT_SHAPE(c);
+                    }
+                } SHAPE_LOOP_END
+                #endif
+                #ifdef WIND_USE_CAPSULE
+                SHAPE_LOOP(l, SHAPE_CAPSULE, capsules, stagedCapsules) {
+                    GpuCapsule shape = SHAPE_AT(capsules, stagedCapsules);
+                    PIXEL_LOOP {
+                        float c = capsuleCoverage(pixelPos[p], shape);
+                        accumulate(s[p], shape.windVec, c);
+                        COUNT_SHAPE(c);
+                    }
+                } SHAPE_LOOP_END
+                #endif
+                #ifdef WIND_USE_POLYGON
+                SHAPE_LOOP(l, SHAPE_POLYGON, polygons, stagedPaths) {
+                    GpuPath shape = SHAPE_AT(polygons, stagedPaths);
+                    PIXEL_LOOP {
+                        float c = polygonCoverage(pixelPos[p], shape);
+                        accumulate(s[p], shape.windVec, c);
+                        COUNT_SHAPE(c);
+                    }
+                } SHAPE_LOOP_END
+                #endif
+                #ifdef WIND_USE_SPLINE_TUBE
+                SHAPE_LOOP(l, SHAPE_SPLINE_TUBE, tubes, stagedPaths) {
+                    GpuPath shape = SHAPE_AT(tubes, stagedPaths);
+                    PIXEL_LOOP {
+                        float c = tubeCoverage(pixelPos[p], shape);
+                        accumulate(s[p], shape.windVec, c);
+                        COUNT_SHAPE(c);
+                    }
+                } SHAPE_LOOP_END
+                #endif
+                #ifdef WIND_USE_VORTEX
+                SHAPE_LOOP(l, SHAPE_VORTEX, vortices, stagedFlows) {
+                    GpuFlow f = SHAPE_AT(vortices, stagedFlows);
+                    PIXEL_LOOP {
+                        float c = flowCoverage(pixelPos[p], f);
+                        accumulate(s[p], vortexWindVec(pixelPos[p], f), c);
+                        COUNT_SHAPE(c);
+                    }
+                } SHAPE_LOOP_END
+                #endif
+                #ifdef WIND_USE_RADIAL
+                SHAPE_LOOP(l, SHAPE_RADIAL, radials, stagedFlows) {
+                    GpuFlow f = SHAPE_AT(radials, stagedFlows);
+                    PIXEL_LOOP {
+                        float c = flowCoverage(pixelPos[p], f);
+                        accumulate(s[p], radialWindVec(pixelPos[p], f), c);
+                        COUNT_SHAPE(c);
+                    }
+                } SHAPE_LOOP_END
+                #endif
+                #ifdef WIND_USE_SOURCE_SINK
+                SHAPE_LOOP(l, SHAPE_SOURCE_SINK, sourceSinks, stagedFlows) {
+                    GpuFlow f = SHAPE_AT(sourceSinks, stagedFlows);
+                    PIXEL_LOOP {
+                        float c = flowCoverage(pixelPos[p], f);
+                        accumulate(s[p], sourceSinkWindVec(pixelPos[p], f), c);
+                        COUNT_SHAPE(c);
+                    }
+                } SHAPE_LOOP_END
+                #endif
+
+                for (int p = 0; p < WIND_PIXEL_COUNT; p++)
+                    totalWindVec[p] = blendLayer(totalWindVec[p], params.layers[l].blendMode, s[p], mask[p]);
+            }
+
+            // 写入RT：RG=向量xy，BA=0（预留）
+            for (int p = 0; p < WIND_PIXEL_COUNT; p++) {
+                if (!inside[p]) continue;
+                #ifdef WIND_DEBUG_COST
+                imageStore(overlapRT, pixelBase + pixelOffset(p), uvec4(overlapCount[p]));
+                #endif
+                imageStore(windRT, storeBase + pixelOffset(p), vec4(totalWindVec[p], 0.0, 0.0));
+            }
+            #ifdef WIND_DEBUG_COST
+            atomicAdd(costCounter.totalShapeTests, shapeTestCount);
+            #endif
+        }
+    )";
+
+// ===================== 风场Shader变体 =====================
+// 变体键：低9位为场景中出现的形状类型，其余位为用到的可选特性、抗锯齿模式与线程布局。
+// 每帧按打包后的参数求键，首次出现的键当场编译并缓存，之后切换场景内容只是换程序；
+// 简单场景（如只有圆形、无遮罩、无衰减指数）得到的程序不含其余形状的循环和分支
+const uint32_t VARIANT_LAYER_MASKS = 1u << 9;     // 有图层启用了遮罩
+const uint32_t VARIANT_RADIAL_FALLOFF = 1u << 10; // 有径向风的衰减指数不为1
+const uint32_t VARIANT_DEBUG_COST = 1u << 11;     // 开销调试计数
+const uint32_t VARIANT_SPARSE = 1u << 12;         // 稀疏虚拟风场
+const int VARIANT_AA_SHIFT = 13;                  // 抗锯齿模式占2位
+const uint32_t VARIANT_SHARED_STAGING = 1u << 15; // 形状分块暂存到共享内存
+const int VARIANT_LAYOUT_SHIFT = 16;              // 线程布局在THREAD_LAYOUTS中的下标，占3位
+
+// 支持的每线程像素数（工作组仍覆盖整个16x16 tile，且不少于64个线程以满足分块暂存）
+const glm::ivec2 THREAD_LAYOUTS[] = {glm::ivec2(1, 1), glm::ivec2(2, 1), glm::ivec2(1, 2), glm::ivec2(2, 2),
+                                     glm::ivec2(4, 1)};
+const int THREAD_LAYOUT_COUNT = sizeof(THREAD_LAYOUTS) / sizeof(THREAD_LAYOUTS[0]);
+
+// 配置的每线程像素数在THREAD_LAYOUTS中的下标，不支持的取值回退到1x1
+int threadLayoutIndex(glm::ivec2 pixelsPerThread)
+{
+    for (int i = 0; i < THREAD_LAYOUT_COUNT; i++)
+    {
+        if (THREAD_LAYOUTS[i] == pixelsPerThread)
+            return i;
+    }
+    return 0;
+}
+
+const char* VARIANT_SHAPE_DEFINES[SHAPE_TYPE_COUNT] = {
+    "WIND_USE_CIRCLE",      "WIND_USE_RECT",   "WIND_USE_SECTOR", "WIND_USE_CAPSULE",     "WIND_USE_POLYGON",
+    "WIND_USE_SPLINE_TUBE", "WIND_USE_VORTEX", "WIND_USE_RADIAL", "WIND_USE_SOURCE_SINK",
+};
+
+std::unordered_map<uint32_t, GLuint> windVariants; // 变体键 -> 程序
+uint32_t activeWindVariant = 0;                    // 最近一次调度使用的变体键
+
+// 在写入参数切片之后调用：windParams已是本帧的打包结果
+uint32_t windVariantKey()
+{
+    uint32_t key = 0;
+    for (int t = 0; t < SHAPE_TYPE_COUNT; t++)
+    {
+        if (*bucketCount(windParams, (ShapeType)t) > 0)
+            key |= 1u << t;
+    }
+    for (int l = 0; l < windParams.layerCount; l++)
+    {
+        if (windParams.layers[l].enabled && windParams.layers[l].useMask)
+            key |= VARIANT_LAYER_MASKS;
+    }
+    // 衰减指数不在参数头部，由形状池在打包/移出时计数
+    if (shapePool.falloffRadials > 0)
+        key |= VARIANT_RADIAL_FALLOFF;
+    if (windConfig.costDebug)
+        key |= VARIANT_DEBUG_COST;
+    if (windConfig.sparse)
+        key |= VARIANT_SPARSE;
+    if (windConfig.sharedStaging)
+        key |= VARIANT_SHARED_STAGING;
+    key |= (uint32_t)windParams.aaMode << VARIANT_AA_SHIFT;
+    key |= (uint32_t)threadLayoutIndex(windConfig.pixelsPerThread) << VARIANT_LAYOUT_SHIFT;
+    return key;
+}
+
+std::string windVariantDefines(uint32_t key)
+{
+    std::string defines;
+    if (key & VARIANT_SPARSE)
+        defines += sparseDefines();
+    if (key & VARIANT_DEBUG_COST)
+        defines += "#define WIND_DEBUG_COST\n";
+    for (int t = 0; t < SHAPE_TYPE_COUNT; t++)
+    {
+        if (key & (1u << t))
+            defines += std::string("#define ") + VARIANT_SHAPE_DEFINES[t] + "\n";
+    }
+    if (key & VARIANT_LAYER_MASKS)
+        defines += "#define WIND_LAYER_MASKS\n";
+    if (key & VARIANT_RADIAL_FALLOFF)
+        defines += "#define WIND_RADIAL_FALLOFF\n";
+    if (key & VARIANT_SHARED_STAGING)
+        defines += "#define WIND_SHARED_STAGING\n";
+    defines += "#define WIND_AA_MODE " + std::to_string((key >> VARIANT_AA_SHIFT) & 3u) + "\n";
+    glm::ivec2 layout = THREAD_LAYOUTS[(key >> VARIANT_LAYOUT_SHIFT) & 7u];
+    defines += "#define WIND_GROUP_X " + std::to_string(TILE_SIZE / layout.x) + "\n#define WIND_GROUP_Y " +
+               std::to_string(TILE_SIZE / layout.y) + "\n";
+    return defines;
+}
+
+// 取键对应的程序，未缓存时编译
+GLuint compileWindVariant(uint32_t key)
+{
+    auto it = windVariants.find(key);
+    if (it != windVariants.end())
+        return it->second;
+    GLuint program = createComputeProgram(std::string(csVersionSource) + windVariantDefines(key) + csCommonSource +
+                                          csSource);
+    windVariants.emplace(key, program);
+    std::cout << "风场Shader变体: 0x" << std::hex << key << std::dec << "（已缓存" << windVariants.size() << "个）"
+              << std::endl;
+    return program;
+}
+
+GLuint windVariantProgram(uint32_t key)
+{
+    activeWindVariant = key;
+    return compileWindVariant(key);
+}
+
+// 预编译key及其相邻变体：多/少一种形状类型、径向衰减开关。返回新编译的个数
+int warmWindVariants(uint32_t key)
+{
+    size_t before = windVariants.size();
+    compileWindVariant(key);
+    for (int t = 0; t < SHAPE_TYPE_COUNT; t++)
+    {
+        uint32_t neighbour = key ^ (1u << t);
+        if (!(neighbour & (1u << SHAPE_RADIAL)))
+            neighbour &= ~VARIANT_RADIAL_FALLOFF;
+        compileWindVariant(neighbour);
+    }
+    if (key & (1u << SHAPE_RADIAL))
+        compileWindVariant(key ^ VARIANT_RADIAL_FALLOFF);
+    return (int)(windVariants.size() - before);
+}
+
+void destroyWindVariants()
+{
+    for (const auto& variant : windVariants)
+        glDeleteProgram(variant.second);
+    windVariants.clear();
+    activeWindVariant = 0;
+}
+
+// ===================== 初始化tile剔除 =====================
+// 占用pass：每个线程负责一个tile，用形状的保守AABB判断是否与tile相交
+void initTileCulling()
+{
+    const char* cullSource = R"(
+        layout(std430, binding = 2) buffer TileList {
+            uint dispatchX;     // 间接调度的工作组数：min(tileCount, TILE_DISPATCH_WIDTH) × 行数
+            uint dispatchY;
+            uint dispatchZ;
+            uint tileCount;     // 被占用tile数
+            uint tiles[];
+        } tileList;
+
+        // 稀疏模式：驻留页中未被占用的tile另列一张表，由清零pass只把这些tile写0，不清整张图集
+        #ifdef WIND_SPARSE
+        layout(std430, binding = 13) buffer EmptyTileList {
+            uint dispatchX;
+            uint dispatchY;
+            uint dispatchZ;
+            uint padding;
+            uint tiles[];       // 页内tile | (页下标 << 6)
+        } emptyTileList;
+        #endif
+
+        layout(local_size_x = 8, local_size_y = 8) in;
+
+        // AABB与tile像素范围相交（外扩一个texel，覆盖抗锯齿的边缘过渡）
+        bool overlaps(vec2 center, vec2 extent, vec2 tileMin, vec2 tileMax) {
+            extent += params.texelSize;
+            return all(lessThanEqual(center - extent, tileMax)) && all(greaterThanEqual(center + extent, tileMin));
+        }
+
+        // ===================== 覆盖图层的整tile判定 =====================
+        // 判定时tile同样外扩一个texel，保证抗锯齿/超采样下覆盖率也为1；只对凸形状做角点测试
+
+        // 圆形（及涡旋/径向/源汇的作用范围）完全包含tile：最远角点在半径内
+        bool circleCoversTile(vec2 center, float radius, vec2 tileMin, vec2 tileMax) {
+            vec2 far = max(abs(tileMin - params.texelSize - center), abs(tileMax + params.texelSize - center));
+            return dot(far, far) <= radius * radius;
+        }
+
+        bool rectCoversTile(GpuRect r, vec2 tileMin, vec2 tileMax) {
+            vec2 lo = tileMin - params.texelSize;
+            vec2 hi = tileMax + params.texelSize;
+            vec2 corners[4] = vec2[4](lo, vec2(hi.x, lo.y), hi, vec2(lo.x, hi.y));
+            for (int k = 0; k < 4; k++) {
+                vec2 delta = corners[k] - r.pos;
+                vec2 local = vec2(dot(delta, r.axis), dot(delta, vec2(-r.axis.y, r.axis.x)));
+                if (any(greaterThan(abs(local), r.halfSize))) return false;
+            }
+            return true;
+        }
+
+        bool capsuleCoversTile(GpuCapsule c, vec2 tileMin, vec2 tileMax) {
+            vec2 lo = tileMin - params.texelSize;
+            vec2 hi = tileMax + params.texelSize;
+            vec2 corners[4] = vec2[4](lo, vec2(hi.x, lo.y), hi, vec2(lo.x, hi.y));
+            vec2 ba = c.b - c.a;
+            for (int k = 0; k < 4; k++) {
+                vec2 pa = corners[k] - c.a;
+                float h = clamp(dot(pa, ba) / max(dot(ba, ba), 1e-8), 0.0, 1.0);
+                if (length(pa - ba * h) > c.radius) return false;
+            }
+            return true;
+        }
+
+        // 遮罩与tile的关系：touches=遮罩可能在tile内生效，covers=遮罩在整个tile上生效
+        bool boxOverlaps(vec2 aMin, vec2 aMax, vec2 bMin, vec2 bMax) {
+            return all(lessThanEqual(aMin, bMax)) && all(greaterThanEqual(aMax, bMin));
+        }
+
+        bool boxInside(vec2 innerMin, vec2 innerMax, vec2 outerMin, vec2 outerMax) {
+            return all(greaterThanEqual(innerMin, outerMin)) && all(lessThanEqual(innerMax, outerMax));
+        }
+
+        bool maskTouchesTile(int l, vec2 tileMin, vec2 tileMax) {
+            if (params.layers[l].useMask == 0) return true;
+            vec2 lo = tileMin - params.texelSize;
+            vec2 hi = tileMax + params.texelSize;
+            if (params.layers[l].invertMask != 0) return !boxInside(lo, hi, params.layers[l].maskMin, params.layers[l].maskMax);
+            return boxOverlaps(lo, hi, params.layers[l].maskMin, params.layers[l].maskMax);
+        }
+
+        bool maskCoversTile(int l, vec2 tileMin, vec2 tileMax) {
+            if (params.layers[l].useMask == 0) return true;
+            vec2 lo = tileMin - params.texelSize;
+            vec2 hi = tileMax + params.texelSize;
+            if (params.layers[l].invertMask != 0) return !boxOverlaps(lo, hi, params.layers[l].maskMin, params.layers[l].maskMax);
+            return boxInside(lo, hi, params.layers[l].maskMin, params.layers[l].maskMax);
+        }
+
+        void main() {
+            #ifdef WIND_SPARSE
+            // 稀疏模式：只枚举驻留页内的tile，线性下标 = 页下标 × 每页tile数 + 页内tile
+            uint linear = gl_WorkGroupID.x * 64u + gl_LocalInvocationIndex;
+            uint pageIndex = linear / uint(WIND_PAGE_TILES * WIND_PAGE_TILES);
+            uint localTile = linear % uint(WIND_PAGE_TILES * WIND_PAGE_TILES);
+            if (pageIndex >= windPages.pageCount) {
+                return;
+            }
+            uint page = windPages.pages[pageIndex].x;
+            ivec2 tileCoord = ivec2(page & 0xFFFFu, page >> 16) * WIND_PAGE_TILES +
+                              ivec2(localTile % uint(WIND_PAGE_TILES), localTile / uint(WIND_PAGE_TILES));
+            uint tileEntry = localTile | (pageIndex << 6);
+            #else
+            ivec2 tileCoord = ivec2(gl_GlobalInvocationID.xy);
+            uint tileEntry = uint(tileCoord.x) | (uint(tileCoord.y) << 12);
+            #endif
+            ivec2 tileCount = (ivec2(params.rtWidth, params.rtHeight) + 15) / 16;
+            if (any(greaterThanEqual(tileCoord, tileCount))) {
+                return;
+            }
+
+            // 像素位置取整数坐标，tile覆盖[min, min+15]个texel，换算到世界坐标
+            vec2 tileMin = params.worldOrigin + vec2(tileCoord * 16) * params.texelSize;
+            vec2 tileMax = tileMin + 15.0 * params.texelSize;
+
+            // 逐层判定占用；覆盖图层若有单个形状完全覆盖tile，记为起始图层，风场pass从该层开始求值
+            bool occupied = false;
+            int startLayer = 0;
+            for (int l = 0; l < params.layerCount; l++) {
+                if (params.layers[l].enabled == 0 || !maskTouchesTile(l, tileMin, tileMax)) continue;
+                // 只需找到一个相交形状；可能成为起始图层时继续找完全覆盖的形状
+                bool canCover = params.layers[l].blendMode == BLEND_OVERRIDE && maskCoversTile(l, tileMin, tileMax);
+                bool layerOccupied = false;
+                bool covered = false;
+                #define LAYER_DONE (layerOccupied && (!canCover || covered))
+
+                for (LAYER_RANGE(l, SHAPE_CIRCLE)) {
+                    if (LAYER_DONE) break;
+                    float r = params.circles[i].radius;
+                    if (!overlaps(params.circles[i].pos, vec2(r), tileMin, tileMax)) continue;
+                    layerOccupied = true;
+                    covered = covered || (canCover && circleCoversTile(params.circles[i].pos, r, tileMin, tileMax));
+                }
+                for (LAYER_RANGE(l, SHAPE_RECT)) {
+                    if (LAYER_DONE) break;
+                    vec2 a = abs(params.rects[i].axis);
+                    vec2 h = params.rects[i].halfSize;
+                    vec2 extent = vec2(a.x * h.x + a.y * h.y, a.y * h.x + a.x * h.y);
+                    if (!overlaps(params.rects[i].pos, extent, tileMin, tileMax)) continue;
+                    layerOccupied = true;
+                    covered = covered || (canCover && rectCoversTile(params.rects[i], tileMin, tileMax));
+                }
+                for (LAYER_RANGE(l, SHAPE_SECTOR)) {
+                    if (LAYER_DONE) break;
+                    layerOccupied = layerOccupied || overlaps(params.sectors[i].pos, vec2(sqrt(params.sectors[i].radiusSq)), tileMin, tileMax);
+                }
+                for (LAYER_RANGE(l, SHAPE_CAPSULE)) {
+                    if (LAYER_DONE) break;
+                    GpuCapsule c = params.capsules[i];
+                    if (!overlaps((c.a + c.b) * 0.5, abs(c.b - c.a) * 0.5 + c.radius, tileMin, tileMax)) continue;
+                    layerOccupied = true;
+                    covered = covered || (canCover && capsuleCoversTile(c, tileMin, tileMax));
+                }
+                for (LAYER_RANGE(l, SHAPE_POLYGON)) {
+                    if (LAYER_DONE) break;
+                    layerOccupied = layerOccupied || overlaps(params.polygons[i].center, params.polygons[i].extent, tileMin, tileMax);
+                }
+                for (LAYER_RANGE(l, SHAPE_SPLINE_TUBE)) {
+                    if (LAYER_DONE) break;
+                    layerOccupied = layerOccupied || overlaps(params.tubes[i].center, params.tubes[i].extent, tileMin, tileMax);
+                }
+                for (LAYER_RANGE(l, SHAPE_VORTEX)) {
+                    if (LAYER_DONE) break;
+                    GpuFlow f = params.vortices[i];
+                    if (!overlaps(f.pos, vec2(f.radius), tileMin, tileMax)) continue;
+                    layerOccupied = true;
+                    covered = covered || (canCover && circleCoversTile(f.pos, f.radius, tileMin, tileMax));
+                }
+                for (LAYER_RANGE(l, SHAPE_RADIAL)) {
+                    if (LAYER_DONE) break;
+                    GpuFlow f = params.radials[i];
+                    if (!overlaps(f.pos, vec2(f.radius), tileMin, tileMax)) continue;
+                    layerOccupied = true;
+                    covered = covered || (canCover && circleCoversTile(f.pos, f.radius, tileMin, tileMax));
+                }
+                for (LAYER_RANGE(l, SHAPE_SOURCE_SINK)) {
+                    if (LAYER_DONE) break;
+                    GpuFlow f = params.sourceSinks[i];
+                    if (!overlaps(f.pos, vec2(f.radius), tileMin, tileMax)) continue;
+                    layerOccupied = true;
+                    covered = covered || (canCover && circleCoversTile(f.pos, f.radius, tileMin, tileMax));
+                }
+
+                occupied = occupied || layerOccupied;
+                if (covered) startLayer = l;
+            }
+
+            if (occupied) {
+                uint slot = atomicAdd(tileList.tileCount, 1u);
+                tileList.tiles[slot] = tileEntry | (uint(startLayer) << 24);
+                atomicMax(tileList.dispatchX, min(slot + 1u, TILE_DISPATCH_WIDTH));
+                atomicMax(tileList.dispatchY, slot / TILE_DISPATCH_WIDTH + 1u);
+            }
+            #ifdef WIND_SPARSE
+            else {
+                uint slot = atomicAdd(emptyTileList.dispatchX, 1u);
+                emptyTileList.tiles[slot] = tileEntry;
+            }
+            #endif
+        }
+    )";
+
+    tileCullProgram = createComputeProgram(std::string(csVersionSource) + csCommonSource + cullSource);
+    sparseCullProgram = createComputeProgram(std::string(csVersionSource) + sparseDefines() + csCommonSource + cullSource);
+}
+
+// 分配容纳tileCount个tile的tile列表（RT全部tile与稀疏模式全部驻留页的tile取大者）；
+// 头部为间接调度参数(x,y,z)与tile数，每帧由resetTileListHeader重置为(0,0,1,0)
+void initTileList(int tileCount)
+{
+    std::vector<GLuint> init(4 + tileCount, 0);
+    init[2] = 1;
+    glGenBuffers(1, &tileListBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileListBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, init.size() * sizeof(GLuint), init.data(), GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// 清空tile列表：调度参数(0,0,1)，tile数0
+void resetTileListHeader()
+{
+    const GLuint header[4] = {0, 0, 1, 0};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileListBuffer);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_RGBA32UI, 0, sizeof(header), GL_RGBA_INTEGER, GL_UNSIGNED_INT,
+                         header);
+}
+
+// ===================== 稀疏虚拟风场 =====================
+// 超大世界不分配整张风场RT：世界按WIND_PAGE_SIZE²个texel分页，只有被形状覆盖的页驻留在物理页图集中并参与计算，
+// 计算量随形状覆盖面积增长。物理图集的页数由WindFieldConfig::atlasPages给出（每页64KB，默认256页约16MB），是显存上限而不随覆盖面积伸缩：
+// 覆盖的页超出容量时，多出的页本帧不计算、计入droppedPages并输出一次警告，neededPages给出所需页数，宿主可据此调大预算。页表（R32UI，每页4字节：0=未驻留，否则为物理槽位+1）用于把虚拟texel换算到图集。
+// 采用软件页表而非ARB_sparse_texture：不依赖驱动支持，且页面提交无需驱动同步。
+// 可视化仍读取windRT：稀疏模式下由解析pass按页表把视口区域拷入windRT。
+struct WindPageState
+{
+    int pagesX = 0; // 虚拟页网格尺寸
+    int pagesY = 0;
+    float texelSize = 0.0f;          // 分配页表时的texel尺寸
+    std::vector<GLuint> table;       // 页表的CPU副本
+    std::vector<int> residentPages;  // 驻留的虚拟页下标
+    std::vector<GLuint> freeSlots;   // 空闲的物理槽位
+    std::vector<int> neededPages;    // 本帧被形状覆盖的虚拟页（复用，避免每帧分配）
+    std::vector<int> changedEntries; // 本帧修改过的页表项
+    std::vector<GLuint> pageList;    // 上传用：头部(count,0,0,0) + 每页(虚拟页x|y<<16, 物理槽位)
+    int droppedPages = 0;            // 超出图集容量、本帧未计算的页数
+    int atlasPages = 0;              // 已分配的图集页数（物理槽位数）
+};
+WindPageState windPages;
+GLuint windAtlas;       // 物理页图集（RGBA32F）
+GLuint pageTableTex;    // 页表纹理（R32UI）
+GLuint pageListBuffer;  // SSBO：驻留页列表
+GLuint emptyTileBuffer; // SSBO：间接调度参数 + 驻留页中未被占用的tile列表
+GLuint atlasClearProgram; // 只清零未被占用tile的pass
+GLuint resolveProgram;  // 视口解析pass
+
+// 形状外接圆半径（与旋转无关），size取当前值或关键帧值
+float shapeBoundingRadius(const WindShape& shape, glm::vec2 size)
+{
+    float pointRadius = 0.0f;
+    for (const glm::vec2& p : shape.points)
+        pointRadius = std::max(pointRadius, glm::length(p));
+
+    switch (shape.type)
+    {
+    case SHAPE_RECT:
+        return glm::length(size) * 0.5f;
+    case SHAPE_CAPSULE:
+        return size.x * 0.5f + size.y;
+    case SHAPE_POLYGON:
+        return pointRadius;
+    case SHAPE_SPLINE_TUBE:
+        return pointRadius * 1.25f + size.x; // Catmull-Rom会略微越出控制点的包围圆
+    default:
+        return size.x; // 圆形/扇形半径，涡旋/径向/源汇作用半径
+    }
+}
+
+// 保守世界AABB；带关键帧时取各关键帧的并集
+void shapeWorldBounds(const WindShape& shape, glm::vec2& lo, glm::vec2& hi)
+{
+    float r = shapeBoundingRadius(shape, shape.size);
+    lo = shape.pos - r;
+    hi = shape.pos + r;
+    for (const ShapeKeyframe& key : shape.keyframes)
+    {
+        r = shapeBoundingRadius(shape, key.size);
+        lo = glm::min(lo, key.pos - r);
+        hi = glm::max(hi, key.pos + r);
+    }
+}
+
+void initSparseWindField()
+{
+    const char* resolveSource = R"(
+        layout(rgba32f, binding = 1) writeonly uniform image2D windRT;
+        uniform sampler2D windAtlas;
+        uniform usampler2D pageTable;
+        uniform vec2 viewOrigin; // 视口（windRT）左下角texel的世界坐标
+        uniform ivec2 viewSize;
+
+        layout(local_size_x = 16, local_size_y = 16) in;
+
+        void main() {
+            ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+            if (any(greaterThanEqual(p, viewSize))) {
+                return;
+            }
+            // 视口与虚拟纹理texel尺寸相同，取最近的虚拟texel
+            vec2 worldPos = viewOrigin + vec2(p) * params.texelSize;
+            ivec2 v = ivec2(floor((worldPos - params.worldOrigin) / params.texelSize + 0.5));
+            vec4 wind = vec4(0.0);
+            if (all(greaterThanEqual(v, ivec2(0))) && all(lessThan(v, ivec2(params.rtWidth, params.rtHeight)))) {
+                uint slot = texelFetch(pageTable, v / WIND_PAGE_SIZE, 0).r;
+                if (slot != 0u) {
+                    slot -= 1u;
+                    ivec2 page = ivec2(slot % uint(WIND_ATLAS_PAGES_X), slot / uint(WIND_ATLAS_PAGES_X));
+                    wind = texelFetch(windAtlas, page * WIND_PAGE_SIZE + v % WIND_PAGE_SIZE, 0);
+                }
+            }
+            imageStore(windRT, p, wind);
+        }
+    )";
+    resolveProgram = createComputeProgram(std::string(csVersionSource) + sparseDefines() + csCommonSource + resolveSource);
+
+    // 每个工作组清零一个未被占用的tile（图集坐标的换算与风场Shader一致）
+    const char* clearSource = R"(
+        layout(rgba32f, binding = 1) writeonly uniform image2D windAtlas;
+        layout(std430, binding = 13) readonly buffer EmptyTileList {
+            uint dispatchX;
+            uint dispatchY;
+            uint dispatchZ;
+            uint padding;
+            uint tiles[];
+        } emptyTileList;
+
+        layout(local_size_x = 16, local_size_y = 16) in;
+
+        void main() {
+            uint entry = emptyTileList.tiles[gl_WorkGroupID.x];
+            uint localTile = entry & 63u;
+            uint slot = windPages.pages[entry >> 6].y;
+            ivec2 local = ivec2(localTile % uint(WIND_PAGE_TILES), localTile / uint(WIND_PAGE_TILES)) * 16 +
+                          ivec2(gl_LocalInvocationID.xy);
+            ivec2 storeCoord = ivec2(slot % uint(WIND_ATLAS_PAGES_X), slot / uint(WIND_ATLAS_PAGES_X)) * WIND_PAGE_SIZE + local;
+            imageStore(windAtlas, storeCoord, vec4(0.0));
+        }
+    )";
+    atlasClearProgram = createComputeProgram(std::string(csVersionSource) + sparseDefines() + csCommonSource + clearSource);
+
+    // 图集与按页数分配的缓冲在ensureWindPages中按预算懒分配
+    glGenTextures(1, &pageTableTex);
+}
+
+// 按页数（重新）分配物理图集、驻留页列表与未占用tile列表：图集宽WIND_ATLAS_PAGES_X页，行数向上取整
+void allocWindAtlas(int pages)
+{
+    if (windPages.atlasPages != 0)
+    {
+        glDeleteTextures(1, &windAtlas);
+        glDeleteBuffers(1, &pageListBuffer);
+        glDeleteBuffers(1, &emptyTileBuffer);
+    }
+    windPages.atlasPages = pages;
+
+    int rows = (pages + WIND_ATLAS_PAGES_X - 1) / WIND_ATLAS_PAGES_X;
+    glGenTextures(1, &windAtlas);
+    glBindTexture(GL_TEXTURE_2D, windAtlas);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, WIND_ATLAS_PAGES_X * WIND_PAGE_SIZE, rows * WIND_PAGE_SIZE, 0, GL_RGBA,
+                 GL_FLOAT, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenBuffers(1, &pageListBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, pageListBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (4 + 2 * pages) * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+
+    // 间接调度参数初始为(0,1,1)，每帧只重置x
+    std::vector<GLuint> init(4 + pages * WIND_PAGE_TILES * WIND_PAGE_TILES, 0);
+    init[1] = 1;
+    init[2] = 1;
+    glGenBuffers(1, &emptyTileBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, emptyTileBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, init.size() * sizeof(GLuint), init.data(), GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// 虚拟世界、texel尺寸或图集页数变化时重建页表（所有页回到未驻留）
+void ensureWindPages()
+{
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    // 虚拟页坐标在页列表中各占16位
+    int maxPages = std::min((int)maxTextureSize, 65535);
+    float texels = WIND_PAGE_SIZE * windConfig.texelSize;
+    int pagesX = std::min(std::max((int)std::ceil(windConfig.virtualSize.x / texels), 1), maxPages);
+    int pagesY = std::min(std::max((int)std::ceil(windConfig.virtualSize.y / texels), 1), maxPages);
+    // 图集高度受纹理尺寸限制；未占用tile的清零pass按一维调度，tile数不能超过X方向工作组数上限
+    int maxAtlasPages = std::min((int)maxTextureSize / WIND_PAGE_SIZE * WIND_ATLAS_PAGES_X,
+                                 65535 / (WIND_PAGE_TILES * WIND_PAGE_TILES));
+    int atlasPages = std::min(std::max(windConfig.atlasPages, 1), maxAtlasPages);
+    if (pagesX == windPages.pagesX && pagesY == windPages.pagesY && windConfig.texelSize == windPages.texelSize &&
+        atlasPages == windPages.atlasPages)
+        return;
+
+    if (atlasPages != windPages.atlasPages)
+    {
+        allocWindAtlas(atlasPages);
+        std::cout << "稀疏风场图集: " << atlasPages << "页 (" << atlasPages * WIND_PAGE_SIZE * WIND_PAGE_SIZE * 16 / 1024
+                  << " KB)" << std::endl;
+        if (atlasPages != windConfig.atlasPages)
+            std::cout << "稀疏风场图集: 请求的" << windConfig.atlasPages << "页超出上限，已截断" << std::endl;
+    }
+    windPages.pagesX = pagesX;
+    windPages.pagesY = pagesY;
+    windPages.texelSize = windConfig.texelSize;
+    windPages.table.assign((size_t)pagesX * pagesY, 0);
+    windPages.residentPages.clear();
+    windPages.freeSlots.clear();
+    for (int slot = windPages.atlasPages - 1; slot >= 0; slot--)
+        windPages.freeSlots.push_back(slot);
+
+    glBindTexture(GL_TEXTURE_2D, pageTableTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, pagesX, pagesY, 0, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                 windPages.table.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    std::cout << "虚拟风场: " << pagesX * WIND_PAGE_SIZE << "x" << pagesY * WIND_PAGE_SIZE << " texel, 页表 "
+              << pagesX << "x" << pagesY << " (" << windPages.table.size() * sizeof(GLuint) / 1024 << " KB)"
+              << std::endl;
+}
+
+// 每帧按形状AABB确定需要的页：保留仍被覆盖的页，释放其余页，再为新覆盖的页分配物理槽位
+void updateWindPages(const std::vector<WindShape>& shapes, const std::vector<WindLayer>& layers)
+{
+    WindPageState& s = windPages;
+    int previousDropped = s.droppedPages;
+    s.neededPages.clear();
+    s.changedEntries.clear();
+    s.droppedPages = 0;
+
+    int layerCount = packedLayerCount(layers);
+    float pageWorldSize = WIND_PAGE_SIZE * windConfig.texelSize;
+    for (const WindShape& shape : shapes)
+    {
+        int layer = shapeLayerIndex(shape, layerCount);
+        if (layer < (int)layers.size() && !layers[layer].enabled)
+            continue;
+        // 外扩一个texel，覆盖抗锯齿的边缘过渡
+        glm::vec2 lo, hi;
+        shapeWorldBounds(shape, lo, hi);
+        glm::vec2 pageLo = glm::floor((lo - windConfig.texelSize - windConfig.virtualOrigin) / pageWorldSize);
+        glm::vec2 pageHi = glm::floor((hi + windConfig.texelSize - windConfig.virtualOrigin) / pageWorldSize);
+        int x0 = std::max((int)pageLo.x, 0);
+        int y0 = std::max((int)pageLo.y, 0);
+        int x1 = std::min((int)pageHi.x, s.pagesX - 1);
+        int y1 = std::min((int)pageHi.y, s.pagesY - 1);
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+                s.neededPages.push_back(y * s.pagesX + x);
+        }
+    }
+    std::sort(s.neededPages.begin(), s.neededPages.end());
+    s.neededPages.erase(std::unique(s.neededPages.begin(), s.neededPages.end()), s.neededPages.end());
+
+    // 释放不再被覆盖的页
+    size_t kept = 0;
+    for (int page : s.residentPages)
+    {
+        if (std::binary_search(s.neededPages.begin(), s.neededPages.end(), page))
+        {
+            s.residentPages[kept++] = page;
+            continue;
+        }
+        s.freeSlots.push_back(s.table[page] - 1);
+        s.table[page] = 0;
+        s.changedEntries.push_back(page);
+    }
+    s.residentPages.resize(kept);
+
+    // 为新覆盖的页分配槽位，图集已满时本帧跳过
+    for (int page : s.neededPages)
+    {
+        if (s.table[page] != 0)
+            continue;
+        if (s.freeSlots.empty())
+        {
+            s.droppedPages++;
+            continue;
+        }
+        s.table[page] = s.freeSlots.back() + 1;
+        s.freeSlots.pop_back();
+        s.residentPages.push_back(page);
+        s.changedEntries.push_back(page);
+    }
+    // 开始丢页时提示一次（持续超出不重复输出）
+    if (s.droppedPages > 0 && previousDropped == 0)
+        std::cout << "稀疏风场: 覆盖" << s.neededPages.size() << "页，超出图集容量" << s.atlasPages << "页，"
+                  << s.droppedPages << "页未计算（调大WindFieldConfig::atlasPages）" << std::endl;
+
+    // 页表：改动少时逐项更新，否则整表上传
+    glBindTexture(GL_TEXTURE_2D, pageTableTex);
+    if ((int)s.changedEntries.size() <= s.pagesX)
+    {
+        for (int page : s.changedEntries)
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, page % s.pagesX, page / s.pagesX, 1, 1, GL_RED_INTEGER,
+                            GL_UNSIGNED_INT, &s.table[page]);
+        }
+    }
+    else
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, s.pagesX, s.pagesY, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                        s.table.data());
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // 驻留页列表：占用pass按它枚举tile
+    s.pageList.assign(4, 0);
+    s.pageList[0] = (GLuint)s.residentPages.size();
+    for (int page : s.residentPages)
+    {
+        s.pageList.push_back((GLuint)(page % s.pagesX) | ((GLuint)(page / s.pagesX) << 16));
+        s.pageList.push_back(s.table[page] - 1);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, pageListBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, s.pageList.size() * sizeof(GLuint), s.pageList.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// 稀疏模式的风场计算：只在驻留页内做占用判定与求值，结果写入图集，再解析出视口
+void dispatchSparseWindField()
+{
+    const GLuint zero = 0;
+    resetTileListHeader();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, tileListBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, emptyTileBuffer);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, emptyTileBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, pageListBuffer);
+
+    // 占用pass：每个工作组64个线程，对应4页×16个tile
+    int residentTiles = (int)windPages.residentPages.size() * WIND_PAGE_TILES * WIND_PAGE_TILES;
+    glUseProgram(sparseCullProgram);
+    glDispatchCompute((residentTiles + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+    // 驻留页中未被占用的tile写0（占用的tile由风场Shader整块写出，两者互不重叠，无需屏障）
+    glBindImageTexture(1, windAtlas, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    glUseProgram(atlasClearProgram);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, emptyTileBuffer);
+    glDispatchComputeIndirect(0);
+    glUseProgram(windVariantProgram(windVariantKey()));
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, tileListBuffer);
+    glDispatchComputeIndirect(0);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    // 解析视口：按页表从图集取值写入windRT
+    glUseProgram(resolveProgram);
+    glUniform1i(glGetUniformLocation(resolveProgram, "windAtlas"), 0);
+    glUniform1i(glGetUniformLocation(resolveProgram, "pageTable"), 1);
+    glUniform2f(glGetUniformLocation(resolveProgram, "viewOrigin"), windConfig.worldOrigin.x, windConfig.worldOrigin.y);
+    glUniform2i(glGetUniformLocation(resolveProgram, "viewSize"), allocatedRTWidth, allocatedRTHeight);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, windAtlas);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, pageTableTex);
+    glBindImageTexture(1, windRT, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    glDispatchCompute((allocatedRTWidth + 15) / 16, (allocatedRTHeight + 15) / 16, 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void destroySparseWindField()
+{
+    glDeleteProgram(resolveProgram);
+    glDeleteProgram(atlasClearProgram);
+    glDeleteProgram(sparseCullProgram);
+    glDeleteTextures(1, &pageTableTex);
+    if (windPages.atlasPages != 0)
+    {
+        glDeleteTextures(1, &windAtlas);
+        glDeleteBuffers(1, &pageListBuffer);
+        glDeleteBuffers(1, &emptyTileBuffer);
+    }
+    // 页网格尺寸与图集页数清零，下一个WindField的ensureWindPages会为新页表纹理重新分配
+    windPages = WindPageState();
+}
+
+// ===================== 分辨率配置 =====================
+// 修改风场分辨率（低端机256x192，编辑器4096x4096），下一帧生效
+void setWindResolution(int width, int height, float texelSize)
+{
+    windConfig.rtWidth = width;
+    windConfig.rtHeight = height;
+    windConfig.texelSize = texelSize;
+}
+
+// 开启稀疏虚拟风场，覆盖[origin, origin+size]的世界区域；RT尺寸与texel尺寸仍由setWindResolution决定
+void setWindVirtualWorld(glm::vec2 origin, glm::vec2 size)
+{
+    windConfig.sparse = true;
+    windConfig.virtualOrigin = origin;
+    windConfig.virtualSize = size;
+}
+
+// 尺寸变化时懒重建RT与tile列表，并把配置写入参数头部
+void ensureWindRT()
+{
+    // 限制在驱动支持的纹理尺寸内；tile坐标在tile列表中各占12位。
+    // tile列表按二维间接调度（见TILE_DISPATCH_WIDTH），tile数不受X方向工作组数上限约束
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    int maxSize = std::min((int)maxTextureSize, 4096 * TILE_SIZE);
+    int width = std::min(std::max(windConfig.rtWidth, 1), maxSize);
+    int height = std::min(std::max(windConfig.rtHeight, 1), maxSize);
+
+    int mipLevels = windConfig.mipmaps ? windMipLevelCount(width, height) : 1;
+    if (width != allocatedRTWidth || height != allocatedRTHeight || mipLevels != allocatedMipLevels)
+    {
+        if (allocatedRTWidth != 0)
+        {
+            glDeleteTextures(1, &windRT);
+            glDeleteTextures(1, &overlapRT);
+        }
+        initWindRT(width, height, mipLevels);
+        allocatedRTWidth = width;
+        allocatedRTHeight = height;
+        allocatedMipLevels = mipLevels;
+        std::cout << "风场RT: " << width << "x" << height << ", texel=" << windConfig.texelSize
+                  << ", mip=" << mipLevels << std::endl;
+        if (width != windConfig.rtWidth || height != windConfig.rtHeight)
+            std::cout << "风场RT: 请求的" << windConfig.rtWidth << "x" << windConfig.rtHeight << "超出纹理尺寸上限，已缩小"
+                      << std::endl;
+    }
+
+    windParams.rtWidth = allocatedRTWidth;
+    windParams.rtHeight = allocatedRTHeight;
+    windParams.texelSize = windConfig.texelSize;
+    windParams.worldOrigin = windConfig.worldOrigin;
+    // 稀疏模式：参数描述虚拟纹理，RT只作为解析视口
+    if (windConfig.sparse)
+    {
+        ensureWindPages();
+        windParams.rtWidth = windPages.pagesX * WIND_PAGE_SIZE;
+        windParams.rtHeight = windPages.pagesY * WIND_PAGE_SIZE;
+        windParams.worldOrigin = windConfig.virtualOrigin;
+    }
+
+    // tile列表容纳RT全部tile与图集全部页的tile（图集未分配时为0），只在所需容量变化时重建
+    int tileCapacity = ((width + TILE_SIZE - 1) / TILE_SIZE) * ((height + TILE_SIZE - 1) / TILE_SIZE);
+    tileCapacity = std::max(tileCapacity, windPages.atlasPages * WIND_PAGE_TILES * WIND_PAGE_TILES);
+    if (tileCapacity != allocatedTileCapacity)
+    {
+        if (allocatedTileCapacity != 0)
+            glDeleteBuffers(1, &tileListBuffer);
+        initTileList(tileCapacity);
+        allocatedTileCapacity = tileCapacity;
+    }
+    windParams.aaMode = windConfig.aaMode;
+    windParams.aaSamples = std::min(std::max(windConfig.aaSamples, 1), 4);
+}
+
+// ===================== 风场mip链 =====================
+// 可选：每帧风场计算（含chunk叠加）之后逐级下采样生成mip链，供远景植被/LOD按足迹选级采样。
+// 不用glGenerateMipmap：RG按向量平均，B存该区域的平均风速（相反的风向量平均后会抵消，
+// 远景仍可用B估计阵风强度）；奇数尺寸时每行/列末尾的目标texel多覆盖一个源texel，不丢数据
+GLuint windMipProgram;
+
+void initWindMips()
+{
+    const char* mipSource = R"(
+        layout(rgba32f, binding = 1) readonly uniform image2D srcLevel;
+        layout(rgba32f, binding = 2) writeonly uniform image2D dstLevel;
+        uniform int fromBase; // 源为第0级：B通道不是平均风速，用|rg|代替
+
+        layout(local_size_x = 8, local_size_y = 8) in;
+
+        void main() {
+            ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+            ivec2 dstSize = imageSize(dstLevel);
+            if (any(greaterThanEqual(p, dstSize))) {
+                return;
+            }
+            ivec2 srcSize = imageSize(srcLevel);
+            ivec2 lo = p * 2;
+            ivec2 hi = ivec2(p.x == dstSize.x - 1 ? srcSize.x - 1 : lo.x + 1,
+                             p.y == dstSize.y - 1 ? srcSize.y - 1 : lo.y + 1);
+            vec2 sum = vec2(0.0);
+            float speed = 0.0;
+            for (int y = lo.y; y <= hi.y; y++) {
+                for (int x = lo.x; x <= hi.x; x++) {
+                    vec4 s = imageLoad(srcLevel, ivec2(x, y));
+                    sum += s.rg;
+                    speed += fromBase != 0 ? length(s.rg) : s.b;
+                }
+            }
+            float count = float((hi.x - lo.x + 1) * (hi.y - lo.y + 1));
+            imageStore(dstLevel, p, vec4(sum / count, speed / count, 0.0));
+        }
+    )";
+    windMipProgram = createComputeProgram(std::string(csVersionSource) + mipSource);
+}
+
+// 在风场计算与chunk叠加之后调用
+void generateWindMips()
+{
+    if (allocatedMipLevels <= 1)
+        return;
+    glUseProgram(windMipProgram);
+    for (int level = 1; level < allocatedMipLevels; level++)
+    {
+        int width = std::max(allocatedRTWidth >> level, 1);
+        int height = std::max(allocatedRTHeight >> level, 1);
+        glUniform1i(glGetUniformLocation(windMipProgram, "fromBase"), level == 1 ? 1 : 0);
+        glBindImageTexture(1, windRT, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(2, windRT, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+        glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+    glBindImageTexture(1, windRT, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void destroyWindMips()
+{
+    glDeleteProgram(windMipProgram);
+}
+
+// ===================== GPU关键帧动画 =====================
+// 带关键帧的形状由compute预pass在GPU上按当前时间求值，直接写入参数切片中预留的桶位置，
+// CPU每帧只为其预留桶位置；关键帧数据仅在动画集合变化时上传一次。
+// 支持圆形/矩形/扇形/胶囊/涡旋/径向/源汇（多边形与样条管道的顶点不做动画）
+GLuint animationProgram; // 动画预pass
+GLuint animationBuffer;  // SSBO：动画形状数组 + 关键帧数组
+int animatedShapeCount = 0;
+
+// 动画形状（48字节）：不随时间变化的属性 + 关键帧区间
+struct GpuAnimatedShape
+{
+    int type;          // 形状类型
+    int slot;          // 在对应桶中的下标
+    int firstKey;      // 关键帧起始下标
+    int keyCount;      // 关键帧数
+    glm::vec2 windDir; // 风向
+    float angleRange;  // 扇形角度范围
+    float falloff;     // 径向风衰减指数
+    int loop;          // 是否循环播放
+    int padding0;
+    int padding1;
+    int padding2;
+};
+
+// 关键帧（32字节），与ShapeKeyframe一一对应
+struct GpuKeyframe
+{
+    float time;
+    float rotation;
+    glm::vec2 pos;
+    glm::vec2 size;
+    float windSpeed;
+    float padding0;
+};
+
+static_assert(sizeof(GpuAnimatedShape) == 48 && sizeof(GpuKeyframe) == 32, "动画数据布局与GLSL不一致");
+
+void initShapeAnimation()
+{
+    const char* animSource = R"(
+        struct GpuAnimatedShape {
+            int type;
+            int slot;
+            int firstKey;
+            int keyCount;
+            vec2 windDir;
+            float angleRange;
+            float falloff;
+            int loop;
+            int padding0;
+            int padding1;
+            int padding2;
+        };
+
+        struct GpuKeyframe {
+            float time;
+            float rotation;
+            vec2 pos;
+            vec2 size;
+            float windSpeed;
+            float padding0;
+        };
+
+        layout(std430, binding = 6) readonly buffer ShapeAnimation {
+            int animatedCount;
+            int padding0;
+            int padding1;
+            int padding2;
+            GpuAnimatedShape shapes[];
+        } animation;
+
+        layout(std430, binding = 7) readonly buffer Keyframes {
+            GpuKeyframe keys[];
+        } keyframes;
+
+        uniform float time;
+
+        layout(local_size_x = 64) in;
+
+        // 在关键帧区间内线性插值
+        GpuKeyframe sampleTrack(GpuAnimatedShape shape) {
+            GpuKeyframe first = keyframes.keys[shape.firstKey];
+            GpuKeyframe last = keyframes.keys[shape.firstKey + shape.keyCount - 1];
+            float duration = last.time - first.time;
+            float t = time - first.time;
+            t = (shape.loop != 0 && duration > 0.0) ? mod(t, duration) : clamp(t, 0.0, duration);
+            t += first.time;
+
+            GpuKeyframe result = last;
+            for (int i = 0; i + 1 < shape.keyCount; i++) {
+                GpuKeyframe a = keyframes.keys[shape.firstKey + i];
+                GpuKeyframe b = keyframes.keys[shape.firstKey + i + 1];
+                if (t <= b.time) {
+                    float w = clamp((t - a.time) / max(b.time - a.time, 1e-6), 0.0, 1.0);
+                    result.rotation = mix(a.rotation, b.rotation, w);
+                    result.pos = mix(a.pos, b.pos, w);
+                    result.size = mix(a.size, b.size, w);
+                    result.windSpeed = mix(a.windSpeed, b.windSpeed, w);
+                    break;
+                }
+            }
+            return result;
+        }
+
+        // 与CPU端packFlow一致
+        GpuFlow makeFlow(GpuAnimatedShape shape, GpuKeyframe key) {
+            GpuFlow flow;
+            flow.pos = key.pos;
+            flow.radius = key.size.x;
+            flow.coreRadius = max(key.size.y, 1e-3);
+            flow.strength = key.windSpeed;
+            flow.falloff = shape.falloff;
+            flow.padding0 = vec2(0.0);
+            return flow;
+        }
+
+        // 与CPU端packWindShapeAt一致的打包
+        void main() {
+            int index = int(gl_GlobalInvocationID.x);
+            if (index >= animation.animatedCount) {
+                return;
+            }
+            GpuAnimatedShape shape = animation.shapes[index];
+            GpuKeyframe key = sampleTrack(shape);
+            vec2 windVec = shape.windDir * key.windSpeed;
+            float rad = radians(key.rotation);
+            vec2 axis = vec2(cos(rad), sin(rad));
+
+            if (shape.type == SHAPE_CIRCLE) {
+                params.circles[shape.slot].pos = key.pos;
+                params.circles[shape.slot].radiusSq = key.size.x * key.size.x;
+                params.circles[shape.slot].radius = key.size.x;
+                params.circles[shape.slot].windVec = windVec;
+            } else if (shape.type == SHAPE_RECT) {
+                params.rects[shape.slot].pos = key.pos;
+                params.rects[shape.slot].halfSize = key.size * 0.5;
+                params.rects[shape.slot].axis = axis;
+                params.rects[shape.slot].windVec = windVec;
+            } else if (shape.type == SHAPE_SECTOR) {
+                float centerRad = radians(key.rotation + shape.angleRange * 0.5);
+                params.sectors[shape.slot].pos = key.pos;
+                params.sectors[shape.slot].radiusSq = key.size.x * key.size.x;
+                params.sectors[shape.slot].cosHalfRange = cos(radians(shape.angleRange * 0.5));
+                params.sectors[shape.slot].centerDir = vec2(cos(centerRad), sin(centerRad));
+                params.sectors[shape.slot].windVec = windVec;
+            } else if (shape.type == SHAPE_CAPSULE) {
+                vec2 halfAxis = axis * (key.size.x * 0.5);
+                params.capsules[shape.slot].a = key.pos - halfAxis;
+                params.capsules[shape.slot].b = key.pos + halfAxis;
+                params.capsules[shape.slot].radius = key.size.y;
+                params.capsules[shape.slot].windVec = windVec;
+            } else if (shape.type == SHAPE_VORTEX) {
+                params.vortices[shape.slot] = makeFlow(shape, key);
+            } else if (shape.type == SHAPE_RADIAL) {
+                params.radials[shape.slot] = makeFlow(shape, key);
+            } else if (shape.type == SHAPE_SOURCE_SINK) {
+                params.sourceSinks[shape.slot] = makeFlow(shape, key);
+            }
+        }
+    )";
+
+    // 动画pass需要写参数缓冲，去掉公共声明中的readonly
+    animationProgram = createComputeProgram(std::string(csVersionSource) + "#define PARAMS_ACCESS\n" +
+                                            csCommonSource + animSource);
+    glGenBuffers(1, &animationBuffer);
+}
+
+// 上传动画形状与关键帧（仅在动画形状变化或搬移了桶位置时调用），槽位取自形状池
+void uploadShapeAnimations(const ShapePoolState& pool)
+{
+    FrameVector<GpuAnimatedShape> animated;
+    FrameVector<GpuKeyframe> keys;
+    for (int dense = 0; dense < (int)pool.shapes.size(); dense++)
+    {
+        const WindShape& shape = pool.shapes[dense];
+        if (pool.packedLayer[dense] < 0 || !isAnimatedShape(shape))
+            continue;
+
+        GpuAnimatedShape a = {};
+        a.type = shape.type;
+        a.slot = pool.packedSlot[dense];
+        a.firstKey = (int)keys.size();
+        a.keyCount = (int)shape.keyframes.size();
+        a.windDir = shape.windDir;
+        a.angleRange = shape.angleRange;
+        a.falloff = shape.falloff;
+        a.loop = shape.loopAnimation ? 1 : 0;
+        animated.push_back(a);
+        for (const ShapeKeyframe& k : shape.keyframes)
+        {
+            GpuKeyframe key = {};
+            key.time = k.time;
+            key.rotation = k.rotation;
+            key.pos = k.pos;
+            key.size = k.size;
+            key.windSpeed = k.windSpeed;
+            keys.push_back(key);
+        }
+    }
+    animatedShapeCount = (int)animated.size();
+    if (animatedShapeCount == 0)
+        return;
+
+    // 布局：16字节头 + 动画形状数组，关键帧数组按SSBO偏移对齐后单独绑定到binding 7
+    GLint alignment = 256;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    GLsizeiptr shapesSize = 16 + animated.size() * sizeof(GpuAnimatedShape);
+    GLsizeiptr keysOffset = (shapesSize + alignment - 1) / alignment * alignment;
+    int header[4] = {animatedShapeCount, 0, 0, 0};
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, animationBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, keysOffset + keys.size() * sizeof(GpuKeyframe), NULL, GL_STATIC_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(header), header);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 16, animated.size() * sizeof(GpuAnimatedShape), animated.data());
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, keysOffset, keys.size() * sizeof(GpuKeyframe), keys.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, animationBuffer);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 7, animationBuffer, keysOffset, keys.size() * sizeof(GpuKeyframe));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// 在bindParamSlice之后、风场计算之前调用：把动画形状写入本帧切片
+void dispatchShapeAnimation(float time)
+{
+    if (animatedShapeCount == 0)
+        return;
+    glUseProgram(animationProgram);
+    glUniform1f(glGetUniformLocation(animationProgram, "time"), time);
+    glDispatchCompute((animatedShapeCount + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void destroyShapeAnimation()
+{
+    glDeleteProgram(animationProgram);
+    glDeleteBuffers(1, &animationBuffer);
+    animatedShapeCount = 0;
+}
+
+// ===================== 开销调试计数 =====================
+void initCostCounter()
+{
+    glGenBuffers(1, &costCounterBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, costCounterBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+
+    const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &costReadbackBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, costReadbackBuffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, PARAM_RING_FRAMES * sizeof(GLuint), NULL, flags);
+    costReadbackPtr = (GLuint*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, PARAM_RING_FRAMES * sizeof(GLuint), flags);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// 在acquireParamSlice之后调用：该切片的fence已完成，其中的计数可直接读取
+void readShapeTestCount()
+{
+    if (windConfig.costDebug)
+    {
+        lastShapeTests = costReadbackPtr[paramRingIndex];
+    }
+}
+
+void destroyCostCounter()
+{
+    glBindBuffer(GL_COPY_WRITE_BUFFER, costReadbackBuffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &costReadbackBuffer);
+    glDeleteBuffers(1, &costCounterBuffer);
+}
+
+// ===================== 调度风场计算 =====================
+// 占用pass -> 整体清零RT -> 只对被占用tile间接调度，GPU耗时与覆盖面积成正比
+void dispatchWindField()
+{
+    if (windConfig.sparse)
+    {
+        dispatchSparseWindField();
+        return;
+    }
+
+    // 步骤1：重置tile计数，运行占用pass
+    const GLuint zero = 0;
+    resetTileListHeader();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, tileListBuffer);
+
+    int tilesX = (allocatedRTWidth + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesY = (allocatedRTHeight + TILE_SIZE - 1) / TILE_SIZE;
+    glUseProgram(tileCullProgram);
+    glDispatchCompute((tilesX + 7) / 8, (tilesY + 7) / 8, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+    // 步骤2：未被占用的tile保持为0
+    glClearTexImage(windRT, 0, GL_RGBA, GL_FLOAT, NULL);
+
+    // 开销调试：清零重叠数与计数
+    if (windConfig.costDebug)
+    {
+        glClearTexImage(overlapRT, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, costCounterBuffer);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, costCounterBuffer);
+        glBindImageTexture(3, overlapRT, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32UI);
+    }
+
+    // 步骤3：按tile列表间接调度风场计算
+    glUseProgram(windVariantProgram(windVariantKey()));
+    glBindImageTexture(1, windRT, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, tileListBuffer);
+    glDispatchComputeIndirect(0);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // 等待计算完成（确保RT写入完成）
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    // 计数拷入当前切片对应的回读位置，由该切片的fence保护
+    if (windConfig.costDebug)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, costCounterBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, costReadbackBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, paramRingIndex * sizeof(GLuint),
+                            sizeof(GLuint));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+}
+
+// sin在[0, π/2]上的128段表（Q16），由离线计算写死，保证各平台一致
+const int32_t FIXED_SIN_TABLE[129] = {
+    0, 804, 1608, 2412, 3216, 4019, 4821, 5623, 6424, 7224, 8022, 8820,
+    9616, 10411, 11204, 11996, 12785, 13573, 14359, 15143, 15924, 16703, 17479, 18253,
+    19024, 19792, 20557, 21320, 22078, 22834, 23586, 24335, 25080, 25821, 26558, 27291,
+    28020, 28745, 29466, 30182, 30893, 31600, 32303, 33000, 33692, 34380, 35062, 35738,
+    36410, 37076, 37736, 38391, 39040, 39683, 40320, 40951, 41576, 42194, 42806, 43412,
+    44011, 44604, 45190, 45769, 46341, 46906, 47464, 48015, 48559, 49095, 49624, 50146,
+    50660, 51166, 51665, 52156, 52639, 53114, 53581, 54040, 54491, 54934, 55368, 55794,
+    56212, 56621, 57022, 57414, 57798, 58172, 58538, 58896, 59244, 59583, 59914, 60235,
+    60547, 60851, 61145, 61429, 61705, 61971, 62228, 62476, 62714, 62943, 63162, 63372,
+    63572, 63763, 63944, 64115, 64277, 64429, 64571, 64704, 64827, 64940, 65043, 65137,
+    65220, 65294, 65358, 65413, 65457, 65492, 65516, 65531, 65536,
+};
+
+// 二进制角的sin（Q16），表间线性插值
+int32_t fixedSin(int32_t angle)
+{
+    angle &= 0xFFFF;
+    int quadrant = angle >> 14;
+    int32_t x = angle & 0x3FFF;
+    if (quadrant & 1)
+        x = 0x4000 - x;
+    int index = x >> 7;
+    int32_t frac = x & 127;
+    int32_t value = FIXED_SIN_TABLE[index];
+    if (index < 128)
+        value += ((FIXED_SIN_TABLE[index + 1] - value) * frac) >> 7;
+    return quadrant >= 2 ? -value : value;
+}
+
+int32_t fixedCos(int32_t angle)
+{
+    return fixedSin(angle + 0x4000);
+}
+
+int32_t degreesToAngle(float degrees)
+{
+    return (int32_t)std::lround(degrees * (65536.0f / 360.0f));
+}
+
+} // namespace
+
+fixed_t toFixed(float v)
+{
+    return (fixed_t)std::lround(v * (float)(1 << FIXED_SHIFT));
+}
+
+namespace
+{
+
+// 64位整数平方根（向下取整），逐位求解，结果与平台无关
+uint32_t isqrt64(uint64_t v)
+{
+    uint64_t result = 0;
+    uint64_t bit = 1ull << 62;
+    while (bit > v)
+        bit >>= 2;
+    while (bit != 0)
+    {
+        if (v >= result + bit)
+        {
+            v -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+// 按形状位置/旋转把局部点变换到世界定点坐标（定点旋转）
+FixedVec2 fixedShapeToWorld(fixed_t posX, fixed_t posY, int32_t c, int32_t s, glm::vec2 local)
+{
+    int64_t lx = toFixed(local.x);
+    int64_t ly = toFixed(local.y);
+    FixedVec2 p;
+    p.x = posX + (fixed_t)((lx * c - ly * s) >> UNIT_SHIFT);
+    p.y = posY + (fixed_t)((lx * s + ly * c) >> UNIT_SHIFT);
+    return p;
+}
+
+void expandBounds(FixedShape& f, fixed_t x, fixed_t y, fixed_t pad)
+{
+    f.minX = std::min(f.minX, x - pad);
+    f.minY = std::min(f.minY, y - pad);
+    f.maxX = std::max(f.maxX, x + pad);
+    f.maxY = std::max(f.maxY, y + pad);
+}
+
+// 定点Catmull-Rom插值，t为Q16
+FixedVec2 fixedCatmullRom(FixedVec2 p0, FixedVec2 p1, FixedVec2 p2, FixedVec2 p3, int64_t t)
+{
+    int64_t t2 = (t * t) >> UNIT_SHIFT;
+    int64_t t3 = (t2 * t) >> UNIT_SHIFT;
+    auto axis = [&](int64_t a, int64_t b, int64_t c, int64_t d) {
+        int64_t sum = 2 * b * (1 << UNIT_SHIFT) + (c - a) * t + (2 * a - 5 * b + 4 * c - d) * t2 +
+                      (3 * b - a - 3 * c + d) * t3;
+        return (fixed_t)(sum >> (UNIT_SHIFT + 1));
+    };
+    return {axis(p0.x, p1.x, p2.x, p3.x), axis(p0.y, p1.y, p2.y, p3.y)};
+}
+
+// 形状姿态的定点量化：关键帧逐个量化后再整数插值，帧间只依赖整数运算
+struct FixedPose
+{
+    int64_t posX, posY;
+    int64_t rotation;      // 二进制角，不取模（插值时不绕近路，与GPU对角度数线性插值一致）
+    int64_t sizeX, sizeY;  // 半径/核半径/胶囊半径
+    int64_t halfX, halfY;  // 矩形半尺寸/胶囊半长
+    int64_t windX, windY;  // 风向×风速
+    int64_t strength;
+};
+
+FixedPose quantizePose(glm::vec2 pos, float rotation, glm::vec2 size, float windSpeed, glm::vec2 windDir)
+{
+    FixedPose pose;
+    pose.posX = toFixed(pos.x);
+    pose.posY = toFixed(pos.y);
+    pose.rotation = degreesToAngle(rotation);
+    pose.sizeX = toFixed(size.x);
+    pose.sizeY = toFixed(size.y);
+    pose.halfX = toFixed(size.x * 0.5f);
+    pose.halfY = toFixed(size.y * 0.5f);
+    pose.windX = toFixed(windDir.x * windSpeed);
+    pose.windY = toFixed(windDir.y * windSpeed);
+    pose.strength = toFixed(windSpeed);
+    return pose;
+}
+
+int64_t keyframeTick(float time)
+{
+    return (int64_t)std::llround((double)time * FIXED_TICKS_PER_SECOND);
+}
+
+// 与GPU动画pass的sampleTrack相同：循环时对时长取模，否则截断到首尾关键帧，区间内线性插值
+FixedPose sampleFixedPose(const WindShape& shape, int64_t tick)
+{
+    const std::vector<ShapeKeyframe>& keys = shape.keyframes;
+    auto quantize = [&](const ShapeKeyframe& k) {
+        return quantizePose(k.pos, k.rotation, k.size, k.windSpeed, shape.windDir);
+    };
+    int64_t first = keyframeTick(keys.front().time);
+    int64_t duration = keyframeTick(keys.back().time) - first;
+    int64_t t = tick - first;
+    if (shape.loopAnimation && duration > 0)
+        t = (t % duration + duration) % duration;
+    else
+        t = std::min(std::max<int64_t>(t, 0), std::max<int64_t>(duration, 0));
+    t += first;
+
+    for (size_t i = 0; i + 1 < keys.size(); i++)
+    {
+        int64_t ta = keyframeTick(keys[i].time);
+        int64_t tb = keyframeTick(keys[i + 1].time);
+        if (t > tb)
+            continue;
+        FixedPose a = quantize(keys[i]);
+        FixedPose b = quantize(keys[i + 1]);
+        int64_t span = std::max<int64_t>(tb - ta, 1);
+        int64_t w = std::min(std::max<int64_t>(t - ta, 0), span);
+        auto mix = [&](int64_t x, int64_t y) { return x + (y - x) * w / span; };
+        FixedPose pose;
+        pose.posX = mix(a.posX, b.posX);
+        pose.posY = mix(a.posY, b.posY);
+        pose.rotation = mix(a.rotation, b.rotation);
+        pose.sizeX = mix(a.sizeX, b.sizeX);
+        pose.sizeY = mix(a.sizeY, b.sizeY);
+        pose.halfX = mix(a.halfX, b.halfX);
+        pose.halfY = mix(a.halfY, b.halfY);
+        pose.windX = mix(a.windX, b.windX);
+        pose.windY = mix(a.windY, b.windY);
+        pose.strength = mix(a.strength, b.strength);
+        return pose;
+    }
+    return quantize(keys.back());
+}
+
+} // namespace
+
+// 把编辑用形状与图层量化为定点风场（形状或图层变化后调用；有关键帧动画时每个tick调用一次）
+void buildFixedWindField(const std::vector<WindShape>& shapes, const std::vector<WindLayer>& layers,
+                         FixedWindField& field, int64_t tick)
+{
+    field.layers.clear();
+    field.shapes.clear();
+    field.vertices.clear();
+    field.segments.clear();
+    // 管道的控制点与折线在各形状间复用容量。此函数在烘焙线程与定点基准中调用，
+    // 不经过帧内存池（只能在渲染线程使用）
+    std::vector<FixedVec2> control;
+    std::vector<FixedVec2> polyline;
+    for (const WindShape& shape : shapes)
+    {
+        FixedShape f = {};
+        f.type = shape.type;
+        f.layer = shapeLayerIndex(shape, std::max((int)layers.size(), 1));
+        // 关键帧动画形状（多边形/管道除外，同GPU）按tick采样姿态，覆盖pos/rotation/size/windSpeed
+        FixedPose pose = isAnimatedShape(shape)
+                             ? sampleFixedPose(shape, tick)
+                             : quantizePose(shape.pos, shape.rotation, shape.size, shape.windSpeed, shape.windDir);
+        f.posX = (fixed_t)pose.posX;
+        f.posY = (fixed_t)pose.posY;
+        f.minX = f.maxX = f.posX;
+        f.minY = f.maxY = f.posY;
+        f.windX = (fixed_t)pose.windX;
+        f.windY = (fixed_t)pose.windY;
+        f.strength = (fixed_t)pose.strength;
+        int32_t rotation = (int32_t)pose.rotation;
+        int32_t c = fixedCos(rotation);
+        int32_t s = fixedSin(rotation);
+
+        switch (shape.type)
+        {
+        case SHAPE_CIRCLE:
+        case SHAPE_VORTEX:
+        case SHAPE_RADIAL:
+        case SHAPE_SOURCE_SINK:
+        case SHAPE_SECTOR:
+        {
+            f.radius = (fixed_t)pose.sizeX;
+            f.radiusSq = (int64_t)f.radius * f.radius;
+            f.coreRadius = std::max<fixed_t>((fixed_t)pose.sizeY, 1);
+            f.falloff = std::min(std::max((int)std::lround(shape.falloff), 0), 8);
+            expandBounds(f, f.posX, f.posY, f.radius);
+            if (shape.type == SHAPE_SECTOR)
+            {
+                int32_t range = degreesToAngle(shape.angleRange);
+                f.startX = c;
+                f.startY = s;
+                f.endX = fixedCos(rotation + range);
+                f.endY = fixedSin(rotation + range);
+                f.sectorMode = range >= 0x10000 ? 2 : (range > 0x8000 ? 1 : 0);
+            }
+            break;
+        }
+        case SHAPE_RECT:
+        case SHAPE_CAPSULE:
+        {
+            f.axisX = c;
+            f.axisY = s;
+            if (shape.type == SHAPE_RECT)
+            {
+                f.halfX = (fixed_t)pose.halfX;
+                f.halfY = (fixed_t)pose.halfY;
+            }
+            else
+            {
+                f.halfX = (fixed_t)pose.halfX;
+                f.radius = (fixed_t)pose.sizeY;
+                f.radiusSq = (int64_t)f.radius * f.radius;
+            }
+            // 旋转后包围盒：|c|*hx + |s|*hy
+            int64_t hx = f.halfX + f.radius;
+            int64_t hy = shape.type == SHAPE_RECT ? f.halfY : f.radius;
+            fixed_t ex = (fixed_t)((std::abs((int64_t)c) * hx + std::abs((int64_t)s) * hy) >> UNIT_SHIFT) + 1;
+            fixed_t ey = (fixed_t)((std::abs((int64_t)s) * hx + std::abs((int64_t)c) * hy) >> UNIT_SHIFT) + 1;
+            f.minX = f.posX - ex;
+            f.maxX = f.posX + ex;
+            f.minY = f.posY - ey;
+            f.maxY = f.posY + ey;
+            break;
+        }
+        case SHAPE_POLYGON:
+        {
+            if (shape.points.size() < 3)
+                continue;
+            f.firstVertex = (int)field.vertices.size();
+            f.count = (int)shape.points.size();
+            f.minX = f.minY = INT32_MAX;
+            f.maxX = f.maxY = INT32_MIN;
+            for (glm::vec2 p : shape.points)
+            {
+                FixedVec2 v = fixedShapeToWorld(f.posX, f.posY, c, s, p);
+                field.vertices.push_back(v);
+                expandBounds(f, v.x, v.y, 0);
+            }
+            break;
+        }
+        case SHAPE_SPLINE_TUBE:
+        {
+            int spans = (int)shape.points.size() - 1;
+            if (spans < 1)
+                continue;
+            f.radius = toFixed(shape.size.x);
+            f.radiusSq = (int64_t)f.radius * f.radius;
+            f.minX = f.minY = INT32_MAX;
+            f.maxX = f.maxY = INT32_MIN;
+
+            control.clear();
+            for (glm::vec2 p : shape.points)
+                control.push_back(fixedShapeToWorld(f.posX, f.posY, c, s, p));
+            polyline.clear();
+            for (int span = 0; span < spans; span++)
+            {
+                FixedVec2 p0 = control[std::max(span - 1, 0)];
+                FixedVec2 p1 = control[span];
+                FixedVec2 p2 = control[span + 1];
+                FixedVec2 p3 = control[std::min(span + 2, spans)];
+                for (int i = 0; i < TUBE_SEGMENTS_PER_SPAN; i++)
+                {
+                    int64_t t = ((int64_t)i << UNIT_SHIFT) / TUBE_SEGMENTS_PER_SPAN;
+                    polyline.push_back(fixedCatmullRom(p0, p1, p2, p3, t));
+                }
+            }
+            polyline.push_back(control.back());
+
+            // 折线每段转为中心+方向+半长，方向由整数平方根归一化
+            f.firstVertex = (int)field.segments.size();
+            for (size_t i = 0; i + 1 < polyline.size(); i++)
+            {
+                int64_t dx = (int64_t)polyline[i + 1].x - polyline[i].x;
+                int64_t dy = (int64_t)polyline[i + 1].y - polyline[i].y;
+                int64_t len = std::max<int64_t>(isqrt64((uint64_t)(dx * dx + dy * dy)), 1);
+                FixedSegment seg;
+                seg.centerX = (fixed_t)((polyline[i].x + (int64_t)polyline[i + 1].x) / 2);
+                seg.centerY = (fixed_t)((polyline[i].y + (int64_t)polyline[i + 1].y) / 2);
+                seg.axisX = (int32_t)(dx * (1 << UNIT_SHIFT) / len);
+                seg.axisY = (int32_t)(dy * (1 << UNIT_SHIFT) / len);
+                seg.halfLength = (fixed_t)(len / 2);
+                field.segments.push_back(seg);
+                expandBounds(f, polyline[i].x, polyline[i].y, f.radius);
+                expandBounds(f, polyline[i + 1].x, polyline[i + 1].y, f.radius);
+            }
+            f.count = (int)field.segments.size() - f.firstVertex;
+            break;
+        }
+        }
+        field.shapes.push_back(f);
+    }
+
+    // 形状按图层分段（同层内保持添加顺序），与GPU桶内的图层段对应
+    std::stable_sort(field.shapes.begin(), field.shapes.end(),
+                     [](const FixedShape& a, const FixedShape& b) { return a.layer < b.layer; });
+    int layerCount = std::max((int)layers.size(), 1);
+    int first = 0;
+    for (int l = 0; l < layerCount; l++)
+    {
+        FixedLayer fl = {};
+        fl.blend = BLEND_ADD;
+        fl.enabled = true;
+        if (l < (int)layers.size())
+        {
+            const WindLayer& layer = layers[l];
+            fl.blend = layer.blend;
+            fl.enabled = layer.enabled;
+            fl.useMask = layer.useMask;
+            fl.invertMask = layer.invertMask;
+            fl.maskMinX = toFixed(layer.maskMin.x);
+            fl.maskMinY = toFixed(layer.maskMin.y);
+            fl.maskMaxX = toFixed(layer.maskMax.x);
+            fl.maskMaxY = toFixed(layer.maskMax.y);
+        }
+        fl.firstShape = first;
+        while (first < (int)field.shapes.size() && field.shapes[first].layer == l)
+            first++;
+        fl.shapeCount = first - fl.firstShape;
+        field.layers.push_back(fl);
+    }
+}
+
+namespace
+{
+
+// 点到“中心+方向+半长”线段的距离平方与半径平方比较（胶囊/管道共用，无除法）
+bool fixedInSegment(int64_t dx, int64_t dy, int32_t axisX, int32_t axisY, int64_t halfLength, int64_t radiusSq)
+{
+    int64_t along = (dx * axisX + dy * axisY) >> UNIT_SHIFT;
+    int64_t across = (dy * axisX - dx * axisY) >> UNIT_SHIFT;
+    int64_t over = along > halfLength ? along - halfLength : (along < -halfLength ? along + halfLength : 0);
+    return over * over + across * across <= radiusSq;
+}
+
+// 速度剖面：核内r/core，核外core/r（Q16）
+int64_t fixedCoreProfile(int64_t r, int64_t core)
+{
+    return r < core ? (r << UNIT_SHIFT) / core : (core << UNIT_SHIFT) / r;
+}
+
+// 单个形状在某点的风：覆盖该点时写入windX/windY并返回true（与GPU二值覆盖一致，
+// 涡旋/径向/源汇在中心处覆盖但风为0）
+inline bool fixedShapeWind(const FixedWindField& field, const FixedShape& f, FixedVec2 point, int64_t& windX, int64_t& windY)
+{
+    if (point.x < f.minX || point.x > f.maxX || point.y < f.minY || point.y > f.maxY)
+        return false;
+    int64_t dx = (int64_t)point.x - f.posX;
+    int64_t dy = (int64_t)point.y - f.posY;
+    int64_t distSq = dx * dx + dy * dy;
+    windX = f.windX;
+    windY = f.windY;
+
+    switch (f.type)
+    {
+    case SHAPE_CIRCLE:
+        return distSq <= f.radiusSq;
+    case SHAPE_RECT:
+    {
+        int64_t localX = (dx * f.axisX + dy * f.axisY) >> UNIT_SHIFT;
+        int64_t localY = (dy * f.axisX - dx * f.axisY) >> UNIT_SHIFT;
+        return std::abs(localX) <= f.halfX && std::abs(localY) <= f.halfY;
+    }
+    case SHAPE_SECTOR:
+    {
+        if (distSq > f.radiusSq)
+            return false;
+        // 叉积判定：在起始方向逆时针侧且在终止方向顺时针侧
+        bool afterStart = dy * f.startX - dx * f.startY >= 0;
+        bool beforeEnd = dx * f.endY - dy * f.endX >= 0;
+        return f.sectorMode == 2 || (f.sectorMode == 1 ? (afterStart || beforeEnd) : (afterStart && beforeEnd));
+    }
+    case SHAPE_CAPSULE:
+        return fixedInSegment(dx, dy, f.axisX, f.axisY, f.halfX, f.radiusSq);
+    case SHAPE_POLYGON:
+    {
+        // 交叉数判定：边跨过点的水平线时用叉积符号代替求交点
+        bool inside = false;
+        const FixedVec2* v = &field.vertices[f.firstVertex];
+        for (int i = 0, j = f.count - 1; i < f.count; j = i++)
+        {
+            if ((v[i].y > point.y) != (v[j].y > point.y))
+            {
+                int64_t cross = ((int64_t)v[j].x - v[i].x) * ((int64_t)point.y - v[i].y) -
+                                ((int64_t)v[j].y - v[i].y) * ((int64_t)point.x - v[i].x);
+                if ((cross > 0) == (v[j].y > v[i].y))
+                    inside = !inside;
+            }
+        }
+        return inside;
+    }
+    case SHAPE_SPLINE_TUBE:
+    {
+        const FixedSegment* segs = &field.segments[f.firstVertex];
+        for (int i = 0; i < f.count; i++)
+        {
+            if (fixedInSegment((int64_t)point.x - segs[i].centerX, (int64_t)point.y - segs[i].centerY, segs[i].axisX,
+                               segs[i].axisY, segs[i].halfLength, f.radiusSq))
+                return true;
+        }
+        return false;
+    }
+    case SHAPE_VORTEX:
+    case SHAPE_RADIAL:
+    case SHAPE_SOURCE_SINK:
+    {
+        if (distSq > f.radiusSq)
+            return false;
+        windX = windY = 0;
+        if (distSq == 0)
+            return true;
+        int64_t r = std::max<int64_t>(isqrt64((uint64_t)distSq), 1);
+        int64_t speed; // Q12
+        if (f.type == SHAPE_RADIAL)
+        {
+            // (1-r/R)^n，Q16
+            int64_t t = std::max<int64_t>(((int64_t)1 << UNIT_SHIFT) - (r << UNIT_SHIFT) / f.radius, 0);
+            int64_t scale = (int64_t)1 << UNIT_SHIFT;
+            for (int i = 0; i < f.falloff; i++)
+                scale = (scale * t) >> UNIT_SHIFT;
+            speed = (f.strength * scale) >> UNIT_SHIFT;
+        }
+        else
+        {
+            speed = (f.strength * fixedCoreProfile(r, f.coreRadius)) >> UNIT_SHIFT;
+        }
+        // 方向：涡旋为切向(-dy, dx)/r，其余为径向(dx, dy)/r
+        windX = (f.type == SHAPE_VORTEX ? -dy : dx) * speed / r;
+        windY = (f.type == SHAPE_VORTEX ? dx : dy) * speed / r;
+        return true;
+    }
+    }
+    return false;
+}
+
+// 二值遮罩：与GPU在AA_NONE下一致，区域边界对正常与反转遮罩都算生效
+bool fixedMaskCovers(const FixedLayer& layer, FixedVec2 point)
+{
+    if (!layer.useMask)
+        return true;
+    if (layer.invertMask)
+        return !(point.x > layer.maskMinX && point.x < layer.maskMaxX && point.y > layer.maskMinY &&
+                 point.y < layer.maskMaxY);
+    return point.x >= layer.maskMinX && point.x <= layer.maskMaxX && point.y >= layer.maskMinY &&
+           point.y <= layer.maskMaxY;
+}
+
+} // namespace
+
+// 单点求值：所有运算为整数，结果逐位确定。
+// 层内按覆盖累加，层间按下标顺序合成（同GPU的blendLayer，二值覆盖下覆盖率只有0或≥1）
+FixedVec2 evaluateFixedWind(const FixedWindField& field, FixedVec2 point)
+{
+    int64_t totalX = 0;
+    int64_t totalY = 0;
+    for (const FixedLayer& layer : field.layers)
+    {
+        if (!layer.enabled || layer.shapeCount == 0 || !fixedMaskCovers(layer, point))
+            continue;
+        int64_t windX = 0;
+        int64_t windY = 0;
+        int64_t gain = 0; // 覆盖形状的风速幅值之和（乘模式用，Q12）
+        bool covered = false;
+        for (int i = layer.firstShape; i < layer.firstShape + layer.shapeCount; i++)
+        {
+            int64_t x, y;
+            if (!fixedShapeWind(field, field.shapes[i], point, x, y))
+                continue;
+            windX += x;
+            windY += y;
+            covered = true;
+            if (layer.blend == BLEND_MULTIPLY)
+                gain += isqrt64((uint64_t)(x * x + y * y));
+        }
+        if (!covered)
+            continue;
+
+        switch (layer.blend)
+        {
+        case BLEND_ADD:
+            totalX += windX;
+            totalY += windY;
+            break;
+        case BLEND_MAX_MAGNITUDE:
+            if (windX * windX + windY * windY > totalX * totalX + totalY * totalY)
+            {
+                totalX = windX;
+                totalY = windY;
+            }
+            break;
+        case BLEND_OVERRIDE:
+            totalX = windX;
+            totalY = windY;
+            break;
+        case BLEND_MULTIPLY:
+            totalX = (totalX * gain) >> FIXED_SHIFT;
+            totalY = (totalY * gain) >> FIXED_SHIFT;
+            break;
+        }
+    }
+    return {(fixed_t)totalX, (fixed_t)totalY};
+}
+
+// 批量求值：按下标区间均分到多个线程，结果与线程数无关
+void evaluateFixedWindBatch(const FixedWindField& field, const FixedVec2* points, FixedVec2* out, size_t count,
+                            int threadCount)
+{
+    threadCount = std::min(std::max(threadCount, 1), FIXED_MAX_THREADS);
+    auto worker = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            out[i] = evaluateFixedWind(field, points[i]);
+    };
+    std::vector<std::thread> threads;
+    size_t chunk = (count + threadCount - 1) / threadCount;
+    for (int t = 1; t < threadCount; t++)
+    {
+        size_t begin = std::min(count, t * chunk);
+        threads.emplace_back(worker, begin, std::min(count, begin + chunk));
+    }
+    worker(0, std::min(count, chunk));
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+// FNV-1a哈希，用于跨机器/跨次运行比对结果
+uint64_t hashFixedWind(const FixedVec2* values, size_t count)
+{
+    uint64_t hash = 1469598103934665603ull;
+    const unsigned char* bytes = (const unsigned char*)values;
+    for (size_t i = 0; i < count * sizeof(FixedVec2); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 基准+确定性检查：单线程与多线程各跑一遍，比较哈希并输出吞吐量；
+// expectedHash非0时（来自另一台机器的输出）一并比对。返回0表示通过
+int runFixedWindBenchmark(const std::vector<WindShape>& shapes, const std::vector<WindLayer>& layers, int threadCount,
+                          uint64_t expectedHash, int64_t tick)
+{
+    FixedWindField field;
+    buildFixedWindField(shapes, layers, field, tick);
+
+    // 在1024x768世界区域内按1/4单位间距采样，共约1260万点
+    const int gridX = 4096;
+    const int gridY = 3072;
+    std::vector<FixedVec2> points((size_t)gridX * gridY);
+    for (int y = 0; y < gridY; y++)
+        for (int x = 0; x < gridX; x++)
+            points[(size_t)y * gridX + x] = {(fixed_t)(x << (FIXED_SHIFT - 2)), (fixed_t)(y << (FIXED_SHIFT - 2))};
+    std::vector<FixedVec2> single(points.size());
+    std::vector<FixedVec2> multi(points.size());
+
+    auto start = std::chrono::steady_clock::now();
+    evaluateFixedWindBatch(field, points.data(), single.data(), points.size(), 1);
+    auto mid = std::chrono::steady_clock::now();
+    evaluateFixedWindBatch(field, points.data(), multi.data(), points.size(), threadCount);
+    auto end = std::chrono::steady_clock::now();
+
+    double singleSec = std::chrono::duration<double>(mid - start).count();
+    double multiSec = std::chrono::duration<double>(end - mid).count();
+    uint64_t singleHash = hashFixedWind(single.data(), single.size());
+    uint64_t multiHash = hashFixedWind(multi.data(), multi.size());
+
+    std::cout << "定点风场: " << points.size() << "点, 1线程 " << points.size() / singleSec / 1e6 << " M点/秒, "
+              << threadCount << "线程 " << points.size() / multiSec / 1e6 << " M点/秒（目标8线程≥100）" << std::endl;
+    std::cout << "哈希: " << std::hex << singleHash << " / " << multiHash << std::dec << std::endl;
+
+    bool ok = singleHash == multiHash && (expectedHash == 0 || singleHash == expectedHash);
+    if (!ok)
+    {
+        std::cerr << "定点风场结果不一致" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
+
+namespace
+{
+
+// ===================== 世界分块流式烘焙 =====================
+// 开放世界的静态风按固定大小的chunk切分，每个chunk有自己的形状子集，烘焙成一块低分辨率风场贴图。
+// 玩家周围的chunk按需请求：后台线程加载形状并用定点求值器烘焙（结果与机器无关），
+// 主线程把完成的贴图上传到GPU图集，图集满时按LRU淘汰最久未使用且不在玩家周围的chunk。
+// 合成pass把烘焙风叠加到windRT上（动态形状照常计算）。
+const float CHUNK_WORLD_SIZE = 256.0f; // chunk边长（世界单位）
+const int CHUNK_BAKE_SIZE = 64;        // 每个chunk烘焙的texel边长（4世界单位/texel）
+const int CHUNK_STREAM_RADIUS = 2;     // 玩家周围(2r+1)²个chunk
+const int CHUNK_TABLE_SIZE = 8;        // 合成用的chunk查找表边长（以玩家所在chunk为中心，需≥2r+1）
+const int CHUNK_MAX_IN_FLIGHT = 8;     // 同时排队/烘焙中的chunk上限，限制CPU端缓冲占用
+
+// chunk坐标打包为64位键
+typedef int64_t ChunkKey;
+
+ChunkKey makeChunkKey(int cx, int cy)
+{
+    return ((int64_t)cx << 32) | (uint32_t)cy;
+}
+
+// 烘焙结果：RG=风向量，行优先
+struct BakedChunk
+{
+    ChunkKey key;
+    std::vector<float> texels;
+};
+
+// 驻留chunk：图集槽位 + LRU链表位置
+struct ResidentChunk
+{
+    int slot;
+    int lastUsedFrame;
+    std::list<ChunkKey>::iterator lruPos;
+};
+
+struct ChunkStreamState
+{
+    // 后台线程共享部分，由mutex保护
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<ChunkKey> requests;
+    std::vector<BakedChunk> results;
+    bool stop = false;
+    std::thread worker;
+
+    // 以下只在主线程访问
+    std::unordered_map<ChunkKey, ResidentChunk> resident;
+    std::unordered_map<ChunkKey, int> inFlight; // 已请求未上传的chunk
+    std::list<ChunkKey> lru;                    // 前端最近使用
+    std::vector<int> freeSlots;
+    int slotCount = 0;
+    int atlasSlotsX = 0;
+    int frame = 0;
+    int evictions = 0;
+    int droppedBakes = 0; // 图集已满（全部为玩家周围chunk）而丢弃的烘焙结果
+    int centerX = 0;      // 玩家所在chunk
+    int centerY = 0;
+    std::vector<GLuint> table; // CHUNK_TABLE_SIZE²，0=无，否则为槽位+1
+};
+ChunkStreamState chunkStream;
+GLuint chunkAtlas;        // 烘焙风图集（RG32F）
+GLuint chunkTableTex;     // chunk查找表（R32UI）
+GLuint chunkComposeProgram;
+
+// 加载chunk形状。这里按chunk坐标的哈希程序化生成，代表从磁盘读取关卡数据；
+// 形状保持在chunk范围内，烘焙时不需要相邻chunk的形状
+void loadChunkShapes(int cx, int cy, std::vector<WindShape>& shapes)
+{
+    uint32_t h = (uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u;
+    auto next = [&h]() {
+        h ^= h << 13;
+        h ^= h >> 17;
+        h ^= h << 5;
+        return (h & 0xFFFF) / 65535.0f;
+    };
+    glm::vec2 origin = glm::vec2(cx, cy) * CHUNK_WORLD_SIZE;
+    int count = 1 + (int)(next() * 3.0f);
+    shapes.clear();
+    for (int i = 0; i < count; i++)
+    {
+        WindShape shape = {};
+        float radius = 30.0f + next() * 50.0f;
+        shape.pos = origin + glm::vec2(radius + next() * (CHUNK_WORLD_SIZE - 2.0f * radius),
+                                       radius + next() * (CHUNK_WORLD_SIZE - 2.0f * radius));
+        float angle = next() * 6.2831853f;
+        shape.windDir = glm::vec2(std::cos(angle), std::sin(angle));
+        shape.windSpeed = 0.1f + next() * 0.3f;
+        if (next() < 0.5f)
+        {
+            shape.type = SHAPE_CIRCLE;
+            shape.size = glm::vec2(radius, 0.0f);
+        }
+        else
+        {
+            shape.type = SHAPE_VORTEX;
+            shape.size = glm::vec2(radius, radius * 0.3f);
+        }
+        shapes.push_back(shape);
+    }
+}
+
+// 烘焙：在每个texel中心用定点求值器计算风向量
+void bakeChunk(ChunkKey key, BakedChunk& baked)
+{
+    int cx = (int)(key >> 32);
+    int cy = (int32_t)(key & 0xFFFFFFFF);
+    std::vector<WindShape> shapes;
+    loadChunkShapes(cx, cy, shapes);
+    FixedWindField field;
+    buildFixedWindField(shapes, std::vector<WindLayer>(), field);
+
+    const float texel = CHUNK_WORLD_SIZE / CHUNK_BAKE_SIZE;
+    std::vector<FixedVec2> points(CHUNK_BAKE_SIZE * CHUNK_BAKE_SIZE);
+    std::vector<FixedVec2> wind(points.size());
+    for (int y = 0; y < CHUNK_BAKE_SIZE; y++)
+    {
+        for (int x = 0; x < CHUNK_BAKE_SIZE; x++)
+        {
+            glm::vec2 p = glm::vec2(cx, cy) * CHUNK_WORLD_SIZE + (glm::vec2(x, y) + 0.5f) * texel;
+            points[y * CHUNK_BAKE_SIZE + x] = {toFixed(p.x), toFixed(p.y)};
+        }
+    }
+    evaluateFixedWindBatch(field, points.data(), wind.data(), points.size(), 1);
+
+    baked.key = key;
+    baked.texels.resize(points.size() * 2);
+    for (size_t i = 0; i < wind.size(); i++)
+    {
+        baked.texels[i * 2] = wind[i].x / (float)(1 << FIXED_SHIFT);
+        baked.texels[i * 2 + 1] = wind[i].y / (float)(1 << FIXED_SHIFT);
+    }
+}
+
+// 后台线程：取请求、加载并烘焙、放入结果队列
+void chunkWorkerLoop()
+{
+    ChunkStreamState& s = chunkStream;
+    while (true)
+    {
+        ChunkKey key;
+        {
+            std::unique_lock<std::mutex> lock(s.mutex);
+            s.wake.wait(lock, [&s]() { return s.stop || !s.requests.empty(); });
+            if (s.stop)
+                return;
+            key = s.requests.front();
+            s.requests.pop_front();
+        }
+        BakedChunk baked;
+        bakeChunk(key, baked);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.results.push_back(std::move(baked));
+    }
+}
+
+void initChunkStreaming()
+{
+    const char* composeSource = R"(
+        layout(rgba32f, binding = 1) uniform image2D windRT;
+        uniform sampler2D chunkAtlas;
+        uniform usampler2D chunkTable;
+        uniform vec2 viewOrigin;   // windRT左下角texel的世界坐标
+        uniform float texelSize;
+        uniform ivec2 viewSize;
+        uniform ivec2 tableOrigin; // 查找表左下角的chunk坐标
+        uniform int atlasSlotsX;
+        uniform float chunkWorldSize;
+        uniform int bakeSize;
+
+        layout(local_size_x = 16, local_size_y = 16) in;
+
+        void main() {
+            ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+            if (any(greaterThanEqual(p, viewSize))) {
+                return;
+            }
+            vec2 worldPos = viewOrigin + vec2(p) * texelSize;
+            vec2 chunkPos = worldPos / chunkWorldSize;
+            ivec2 t = ivec2(floor(chunkPos)) - tableOrigin;
+            if (any(lessThan(t, ivec2(0))) || any(greaterThanEqual(t, textureSize(chunkTable, 0)))) {
+                return;
+            }
+            uint slot = texelFetch(chunkTable, t, 0).r;
+            if (slot == 0u) {
+                return;
+            }
+            slot -= 1u;
+            // 槽位内双线性采样，坐标收缩半个texel，避免采到相邻槽位
+            vec2 local = clamp(fract(chunkPos) * float(bakeSize), vec2(0.5), vec2(float(bakeSize) - 0.5));
+            vec2 texel = vec2(slot % uint(atlasSlotsX), slot / uint(atlasSlotsX)) * float(bakeSize) + local;
+            vec2 baked = texture(chunkAtlas, texel / vec2(textureSize(chunkAtlas, 0))).rg;
+            imageStore(windRT, p, imageLoad(windRT, p) + vec4(baked, 0.0, 0.0));
+        }
+    )";
+    chunkComposeProgram = createComputeProgram(std::string(csVersionSource) + composeSource);
+
+    // 槽位数受显存预算约束：图集每行atlasSlotsX个槽位，只保留整行（纹理字节数不超过预算），
+    // 如3MB预算可容纳96个槽位，排成10x9共90个
+    ChunkStreamState& s = chunkStream;
+    size_t chunkBytes = (size_t)CHUNK_BAKE_SIZE * CHUNK_BAKE_SIZE * 2 * sizeof(float);
+    int budgetSlots = std::max((int)(chunkConfig.memoryBudget / chunkBytes), 1);
+    s.atlasSlotsX = (int)std::ceil(std::sqrt((double)budgetSlots));
+    int atlasSlotsY = std::max(budgetSlots / s.atlasSlotsX, 1);
+    s.slotCount = std::min(s.atlasSlotsX * atlasSlotsY, budgetSlots);
+    for (int slot = s.slotCount - 1; slot >= 0; slot--)
+        s.freeSlots.push_back(slot);
+    s.table.assign(CHUNK_TABLE_SIZE * CHUNK_TABLE_SIZE, 0);
+
+    glGenTextures(1, &chunkAtlas);
+    glBindTexture(GL_TEXTURE_2D, chunkAtlas);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, s.atlasSlotsX * CHUNK_BAKE_SIZE, atlasSlotsY * CHUNK_BAKE_SIZE, 0, GL_RG,
+                 GL_FLOAT, NULL);
+
+    glGenTextures(1, &chunkTableTex);
+    glBindTexture(GL_TEXTURE_2D, chunkTableTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, CHUNK_TABLE_SIZE, CHUNK_TABLE_SIZE, 0, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                 s.table.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// 为完成的烘焙分配槽位：优先空闲槽位，否则淘汰LRU末端中本帧未使用的chunk
+int acquireChunkSlot()
+{
+    ChunkStreamState& s = chunkStream;
+    if (!s.freeSlots.empty())
+    {
+        int slot = s.freeSlots.back();
+        s.freeSlots.pop_back();
+        return slot;
+    }
+    if (s.lru.empty())
+        return -1;
+    ChunkKey victim = s.lru.back();
+    ResidentChunk& chunk = s.resident[victim];
+    if (chunk.lastUsedFrame == s.frame)
+        return -1;
+    int slot = chunk.slot;
+    s.lru.pop_back();
+    s.resident.erase(victim);
+    s.evictions++;
+    return slot;
+}
+
+// 每帧：标记玩家周围的chunk、请求缺失的chunk、上传完成的烘焙、更新查找表
+void updateChunkStreaming(glm::vec2 playerPos)
+{
+    ChunkStreamState& s = chunkStream;
+    // 烘焙线程在第一次开启流式烘焙时才启动，未使用chunk的程序不多占一个线程
+    if (!s.worker.joinable())
+        s.worker = std::thread(chunkWorkerLoop);
+    s.frame++;
+    s.centerX = (int)std::floor(playerPos.x / CHUNK_WORLD_SIZE);
+    s.centerY = (int)std::floor(playerPos.y / CHUNK_WORLD_SIZE);
+
+    // 由近到远：驻留的移到LRU前端，缺失的加入请求队列
+    FrameVector<ChunkKey> missing;
+    for (int ring = 0; ring <= CHUNK_STREAM_RADIUS; ring++)
+    {
+        for (int dy = -ring; dy <= ring; dy++)
+        {
+            for (int dx = -ring; dx <= ring; dx++)
+            {
+                if (std::max(std::abs(dx), std::abs(dy)) != ring)
+                    continue;
+                ChunkKey key = makeChunkKey(s.centerX + dx, s.centerY + dy);
+                auto it = s.resident.find(key);
+                if (it != s.resident.end())
+                {
+                    it->second.lastUsedFrame = s.frame;
+                    s.lru.splice(s.lru.begin(), s.lru, it->second.lruPos);
+                }
+                else if (!s.inFlight.count(key) && (int)s.inFlight.size() + (int)missing.size() < CHUNK_MAX_IN_FLIGHT)
+                {
+                    missing.push_back(key);
+                }
+            }
+        }
+    }
+
+    FrameVector<BakedChunk> finished;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (ChunkKey key : missing)
+            s.requests.push_back(key);
+        // 移出结果而不是交换，results保留容量，工作线程不必每帧重新分配
+        finished.reserve(s.results.size());
+        for (BakedChunk& baked : s.results)
+            finished.push_back(std::move(baked));
+        s.results.clear();
+    }
+    for (ChunkKey key : missing)
+        s.inFlight[key] = s.frame;
+    if (!missing.empty())
+        s.wake.notify_one();
+
+    // 上传完成的烘焙
+    glBindTexture(GL_TEXTURE_2D, chunkAtlas);
+    for (const BakedChunk& baked : finished)
+    {
+        s.inFlight.erase(baked.key);
+        int slot = acquireChunkSlot();
+        if (slot < 0)
+        {
+            s.droppedBakes++;
+            continue;
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % s.atlasSlotsX) * CHUNK_BAKE_SIZE,
+                        (slot / s.atlasSlotsX) * CHUNK_BAKE_SIZE, CHUNK_BAKE_SIZE, CHUNK_BAKE_SIZE, GL_RG, GL_FLOAT,
+                        baked.texels.data());
+        s.lru.push_front(baked.key);
+        s.resident[baked.key] = {slot, s.frame, s.lru.begin()};
+    }
+
+    // 查找表以玩家所在chunk为中心
+    int originX = s.centerX - CHUNK_TABLE_SIZE / 2;
+    int originY = s.centerY - CHUNK_TABLE_SIZE / 2;
+    for (int y = 0; y < CHUNK_TABLE_SIZE; y++)
+    {
+        for (int x = 0; x < CHUNK_TABLE_SIZE; x++)
+        {
+            auto it = s.resident.find(makeChunkKey(originX + x, originY + y));
+            s.table[y * CHUNK_TABLE_SIZE + x] = it != s.resident.end() ? it->second.slot + 1 : 0;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, chunkTableTex);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, CHUNK_TABLE_SIZE, CHUNK_TABLE_SIZE, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                    s.table.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// 在风场计算之后调用：把烘焙风叠加到windRT
+void composeChunkWind()
+{
+    ChunkStreamState& s = chunkStream;
+    glUseProgram(chunkComposeProgram);
+    glUniform1i(glGetUniformLocation(chunkComposeProgram, "chunkAtlas"), 0);
+    glUniform1i(glGetUniformLocation(chunkComposeProgram, "chunkTable"), 1);
+    glUniform2f(glGetUniformLocation(chunkComposeProgram, "viewOrigin"), windConfig.worldOrigin.x,
+                windConfig.worldOrigin.y);
+    glUniform1f(glGetUniformLocation(chunkComposeProgram, "texelSize"), windConfig.texelSize);
+    glUniform2i(glGetUniformLocation(chunkComposeProgram, "viewSize"), allocatedRTWidth, allocatedRTHeight);
+    glUniform2i(glGetUniformLocation(chunkComposeProgram, "tableOrigin"), s.centerX - CHUNK_TABLE_SIZE / 2,
+                s.centerY - CHUNK_TABLE_SIZE / 2);
+    glUniform1i(glGetUniformLocation(chunkComposeProgram, "atlasSlotsX"), s.atlasSlotsX);
+    glUniform1f(glGetUniformLocation(chunkComposeProgram, "chunkWorldSize"), CHUNK_WORLD_SIZE);
+    glUniform1i(glGetUniformLocation(chunkComposeProgram, "bakeSize"), CHUNK_BAKE_SIZE);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, chunkAtlas);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, chunkTableTex);
+    glBindImageTexture(1, windRT, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+    glDispatchCompute((allocatedRTWidth + 15) / 16, (allocatedRTHeight + 15) / 16, 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void destroyChunkStreaming()
+{
+    ChunkStreamState& s = chunkStream;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.stop = true;
+    }
+    s.wake.notify_one();
+    if (s.worker.joinable())
+        s.worker.join();
+    glDeleteProgram(chunkComposeProgram);
+    glDeleteTextures(1, &chunkAtlas);
+    glDeleteTextures(1, &chunkTableTex);
+
+    // 线程已退出，恢复初始状态，下一个WindField可重新启动烘焙线程、重新填充空闲槽位
+    s.requests.clear();
+    s.results.clear();
+    s.stop = false;
+    s.resident.clear();
+    s.inFlight.clear();
+    s.lru.clear();
+    s.freeSlots.clear();
+    s.slotCount = 0;
+    s.atlasSlotsX = 0;
+    s.frame = 0;
+    s.evictions = 0;
+    s.droppedBakes = 0;
+    s.centerX = 0;
+    s.centerY = 0;
+    s.table.clear();
+}
+
+
+// ===================== 粒子风速查询 =====================
+// GPU粒子的位置在调用方的SSBO中，查询pass直接在GPU上读取位置、写出风速，不经过CPU。
+// 视口（windRT）内用硬件插值采样，包含叠加的chunk风，有mip链时按足迹选级；稀疏模式下视口外经页表取图集，
+// 4个texel手动插值（相邻texel可能在不同的物理页）；两者之外风速为0
+GLuint particleQueryProgram;
+GLuint particleSampler; // 三线性采样windRT，与windRT自身的过滤设置无关
+
+void initParticleQuery()
+{
+    const char* particleSource = R"(
+        layout(std430, binding = 9) readonly buffer ParticlePositions {
+            float positions[];
+        };
+        layout(std430, binding = 10) writeonly buffer ParticleWind {
+            float wind[];
+        };
+        uniform sampler2D windRT;
+        uniform sampler2D windAtlas;
+        uniform usampler2D pageTable;
+        uniform int particleCount;
+        uniform int positionStride; // 以float计：每个粒子的步长，位置xy在开头
+        uniform int windStride;
+        uniform vec2 viewOrigin;    // windRT左下角texel的世界坐标
+        uniform vec2 viewSize;      // windRT尺寸（texel）
+        uniform float texelSize;
+        uniform float lod;          // 按查询足迹选择的mip级（无mip链时为0）
+        uniform int sparse;
+        uniform vec2 virtualOrigin; // 虚拟风场左下角texel的世界坐标与尺寸（texel）
+        uniform ivec2 virtualSize;
+
+        layout(local_size_x = 64) in;
+
+        vec2 fetchVirtual(ivec2 v) {
+            if (any(lessThan(v, ivec2(0))) || any(greaterThanEqual(v, virtualSize))) {
+                return vec2(0.0);
+            }
+            uint slot = texelFetch(pageTable, v / WIND_PAGE_SIZE, 0).r;
+            if (slot == 0u) {
+                return vec2(0.0);
+            }
+            slot -= 1u;
+            ivec2 page = ivec2(slot % uint(WIND_ATLAS_PAGES_X), slot / uint(WIND_ATLAS_PAGES_X));
+            return texelFetch(windAtlas, page * WIND_PAGE_SIZE + v % WIND_PAGE_SIZE, 0).rg;
+        }
+
+        void main() {
+            int i = int(gl_GlobalInvocationID.x);
+            if (i >= particleCount) {
+                return;
+            }
+            vec2 worldPos = vec2(positions[i * positionStride], positions[i * positionStride + 1]);
+            vec2 v = vec2(0.0);
+            // texel中心在(p + 0.5)，texel p的世界坐标为origin + p * texelSize
+            vec2 texel = (worldPos - viewOrigin) / texelSize;
+            if (all(greaterThanEqual(texel, vec2(-0.5))) && all(lessThan(texel, viewSize - 0.5))) {
+                v = textureLod(windRT, (texel + 0.5) / viewSize, lod).rg;
+            } else if (sparse != 0) {
+                vec2 t = (worldPos - virtualOrigin) / texelSize;
+                ivec2 base = ivec2(floor(t));
+                vec2 f = t - vec2(base);
+                vec2 bottom = mix(fetchVirtual(base), fetchVirtual(base + ivec2(1, 0)), f.x);
+                vec2 top = mix(fetchVirtual(base + ivec2(0, 1)), fetchVirtual(base + ivec2(1, 1)), f.x);
+                v = mix(bottom, top, f.y);
+            }
+            wind[i * windStride] = v.x;
+            wind[i * windStride + 1] = v.y;
+        }
+    )";
+    particleQueryProgram = createComputeProgram(std::string(csVersionSource) + sparseDefines() + particleSource);
+
+    glGenSamplers(1, &particleSampler);
+    glSamplerParameteri(particleSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(particleSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(particleSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(particleSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+// 在compute()之后调用；写入结果后插入存储屏障，后续读取风速的粒子pass无需再加
+void dispatchParticleQuery(GLuint positions, GLintptr positionOffset, int positionStride, GLuint wind,
+                           GLintptr windOffset, int windStride, int count, float footprint)
+{
+    if (count <= 0 || allocatedRTWidth == 0)
+        return;
+    GLuint program = particleQueryProgram;
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "windRT"), 0);
+    glUniform1i(glGetUniformLocation(program, "windAtlas"), 1);
+    glUniform1i(glGetUniformLocation(program, "pageTable"), 2);
+    glUniform1i(glGetUniformLocation(program, "particleCount"), count);
+    glUniform1i(glGetUniformLocation(program, "positionStride"), positionStride);
+    glUniform1i(glGetUniformLocation(program, "windStride"), windStride);
+    glUniform2f(glGetUniformLocation(program, "viewOrigin"), windConfig.worldOrigin.x, windConfig.worldOrigin.y);
+    glUniform2f(glGetUniformLocation(program, "viewSize"), (float)allocatedRTWidth, (float)allocatedRTHeight);
+    glUniform1f(glGetUniformLocation(program, "texelSize"), windConfig.texelSize);
+    // 足迹覆盖2^n个texel时取第n级，超出mip链的部分由采样器钳制到最粗一级
+    float lod = footprint > windConfig.texelSize ? std::log2(footprint / windConfig.texelSize) : 0.0f;
+    glUniform1f(glGetUniformLocation(program, "lod"), allocatedMipLevels > 1 ? lod : 0.0f);
+    glUniform1i(glGetUniformLocation(program, "sparse"), windConfig.sparse ? 1 : 0);
+    glUniform2f(glGetUniformLocation(program, "virtualOrigin"), windParams.worldOrigin.x, windParams.worldOrigin.y);
+    glUniform2i(glGetUniformLocation(program, "virtualSize"), windParams.rtWidth, windParams.rtHeight);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, windRT);
+    glBindSampler(0, particleSampler);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, windAtlas);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, pageTableTex);
+    // 大小按实际读写的范围计算，偏移需满足GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 9, positions, positionOffset,
+                      (GLsizeiptr)((count - 1) * positionStride + 2) * sizeof(float));
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 10, wind, windOffset,
+                      (GLsizeiptr)((count - 1) * windStride + 2) * sizeof(float));
+    glDispatchCompute((count + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+    glBindSampler(0, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void destroyParticleQuery()
+{
+    glDeleteProgram(particleQueryProgram);
+    glDeleteSamplers(1, &particleSampler);
+}
+
+// ===================== 形状命令队列 =====================
+// 游戏逻辑线程提交的形状编辑：无锁MPSC栈，生产者CAS压入，渲染线程每帧一次exchange取走整批，
+// 翻转为提交顺序后按形状合并（多次更新只保留最后一次，添加后又删除则整体抵消）再写入形状池。
+// 队列添加的形状在提交时还没有池句柄，先分配最高位为1的队列id，取出时映射到池句柄
+const uint32_t QUEUED_SHAPE_ID_BIT = 0x80000000u;
+
+enum ShapeCommandType : int
+{
+    SHAPE_COMMAND_ADD = 0,
+    SHAPE_COMMAND_UPDATE = 1,
+    SHAPE_COMMAND_REMOVE = 2
+};
+
+struct ShapeCommand
+{
+    ShapeCommandType type;
+    WindShapeId id;
+    WindShape shape;
+    ShapeCommand* next = nullptr;
+};
+
+struct ShapeCommandQueueState
+{
+    std::atomic<ShapeCommand*> head{nullptr};
+    std::atomic<uint32_t> nextQueuedId{0};
+    std::unordered_map<WindShapeId, WindShapeId> queuedHandles; // 队列id -> 池句柄（仅渲染线程访问）
+    int drainedCommands = 0;   // 最近一次取出的命令数与合并后实际执行数
+    int appliedCommands = 0;
+};
+ShapeCommandQueueState shapeQueue;
+
+void pushShapeCommand(ShapeCommandType type, WindShapeId id, const WindShape& shape)
+{
+    ShapeCommand* command = new ShapeCommand{type, id, shape};
+    ShapeCommand* head = shapeQueue.head.load(std::memory_order_relaxed);
+    do
+    {
+        command->next = head;
+    } while (!shapeQueue.head.compare_exchange_weak(head, command, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+}
+
+WindShapeId reserveQueuedShapeId()
+{
+    return shapeQueue.nextQueuedId.fetch_add(1, std::memory_order_relaxed) | QUEUED_SHAPE_ID_BIT;
+}
+
+// 队列id映射到池句柄，池句柄原样返回；映射不存在（已删除或被合并抵消）时返回0
+WindShapeId resolveShapeId(WindShapeId id)
+{
+    if (!(id & QUEUED_SHAPE_ID_BIT))
+        return id;
+    auto it = shapeQueue.queuedHandles.find(id);
+    return it == shapeQueue.queuedHandles.end() ? 0 : it->second;
+}
+
+void applyShapeCommand(const ShapeCommand& command)
+{
+    switch (command.type)
+    {
+    case SHAPE_COMMAND_ADD:
+        shapeQueue.queuedHandles[command.id] = addPoolShape(shapePool, command.shape);
+        break;
+    case SHAPE_COMMAND_UPDATE:
+        updatePoolShape(shapePool, resolveShapeId(command.id), command.shape);
+        break;
+    case SHAPE_COMMAND_REMOVE:
+        removePoolShape(shapePool, resolveShapeId(command.id));
+        shapeQueue.queuedHandles.erase(command.id);
+        break;
+    }
+}
+
+// 渲染线程每帧调用一次：取走整批命令，合并后写入形状池
+void drainShapeCommands()
+{
+    ShapeCommandQueueState& q = shapeQueue;
+    size_t count = 0;
+    ShapeCommand* head = q.head.exchange(nullptr, std::memory_order_acquire);
+    for (ShapeCommand* c = head; c; c = c->next)
+        count++;
+    q.drainedCommands = (int)count;
+    q.appliedCommands = 0;
+    if (count == 0)
+        return;
+
+    // 本帧取出的命令（提交顺序）与合并表都在帧内存池上
+    FrameVector<ShapeCommand*> batch(count);
+    for (ShapeCommand* c = head; c; c = c->next)
+        batch[--count] = c;
+    typedef std::pair<const WindShapeId, size_t> PendingEntry;
+    std::unordered_map<WindShapeId, size_t, std::hash<WindShapeId>, std::equal_to<WindShapeId>,
+                       FrameAllocator<PendingEntry>>
+        pending(batch.size() * 2);
+
+    // 同一形状的后续命令并入先出现的那条：添加+更新=添加，更新+更新=更新，
+    // 添加+删除=抵消，更新+删除=删除；被并掉的命令置空
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        ShapeCommand* c = batch[i];
+        auto it = pending.find(c->id);
+        if (it == pending.end())
+        {
+            pending.emplace(c->id, i);
+            continue;
+        }
+        ShapeCommand*& kept = batch[it->second];
+        if (!kept || kept->type == SHAPE_COMMAND_REMOVE)
+        {
+            // 已抵消或已删除的形状，后续命令无效
+        }
+        else if (c->type == SHAPE_COMMAND_REMOVE && kept->type == SHAPE_COMMAND_ADD)
+        {
+            delete kept;
+            kept = nullptr;
+        }
+        else if (c->type == SHAPE_COMMAND_REMOVE)
+        {
+            kept->type = SHAPE_COMMAND_REMOVE;
+        }
+        else
+        {
+            kept->shape = std::move(c->shape);
+        }
+        delete c;
+        batch[i] = nullptr;
+    }
+
+    for (ShapeCommand* c : batch)
+    {
+        if (!c)
+            continue;
+        applyShapeCommand(*c);
+        q.appliedCommands++;
+        delete c;
+    }
+}
+
+} // namespace
+
+// ===================== 帧基准 =====================
+// 无GL的逐帧CPU路径：每帧经命令队列生成一批短命阵风（存活若干帧，期间每帧更新一次位置），
+// 然后按compute()的顺序重置帧内存池、合并命令、同步形状池并写参数切片。
+// 输出每帧耗时与帧内存池的分配统计；预热后仍向堆申请新块则返回1。
+// 借用全局的形状池、windParams与队列id映射，返回前恢复原状
+const int FRAME_BENCH_GUST_FRAMES = 6;
+
+int runFrameBenchmark(int frames, int gustsPerFrame)
+{
+    ShapePoolState savedPool = std::move(shapePool);
+    WindFieldParams savedParams = windParams;
+    std::unordered_map<WindShapeId, WindShapeId> savedHandles;
+    savedHandles.swap(shapeQueue.queuedHandles);
+    shapePool = ShapePoolState();
+
+    std::vector<WindLayer> layers(1);
+    std::vector<WindFieldParams> slices(PARAM_RING_FRAMES);
+    std::deque<std::pair<WindShapeId, int>> gusts; // 队列id与到期帧
+    long long allocations = 0;
+    size_t bytes = 0;
+    int warmBlocks = 0;
+    int steadyBlocks = 0;
+    double seconds = 0.0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        // 生产者：删除到期阵风，更新存活阵风，生成新阵风
+        while (!gusts.empty() && gusts.front().second <= frame)
+        {
+            pushShapeCommand(SHAPE_COMMAND_REMOVE, gusts.front().first, WindShape());
+            gusts.pop_front();
+        }
+        WindShape gust;
+        gust.type = SHAPE_CIRCLE;
+        gust.size = glm::vec2(30.0f);
+        gust.windSpeed = 0.6f;
+        for (auto& live : gusts)
+        {
+            gust.pos = glm::vec2((float)(live.first % 1024), (float)frame);
+            pushShapeCommand(SHAPE_COMMAND_UPDATE, live.first, gust);
+        }
+        for (int i = 0; i < gustsPerFrame; i++)
+        {
+            WindShapeId id = reserveQueuedShapeId();
+            gust.pos = glm::vec2((float)(id % 1024), (float)frame);
+            pushShapeCommand(SHAPE_COMMAND_ADD, id, gust);
+            gusts.emplace_back(id, frame + FRAME_BENCH_GUST_FRAMES);
+        }
+
+        // 渲染侧
+        auto start = std::chrono::high_resolution_clock::now();
+        resetFrameArena();
+        drainShapeCommands();
+        syncShapePool(shapePool, layers, windParams);
+        if (shapePool.animationsDirty)
+            shapePool.animationsDirty = false;
+        int ring = frame % PARAM_RING_FRAMES;
+        writeParamSlice(&slices[ring], windParams, shapePool.dirty[ring]);
+        seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        allocations += frameArena.frameAllocations;
+        bytes += frameArena.frameBytes;
+        if (frame < frames / 2)
+            warmBlocks += frameArena.frameBlockAllocations;
+        else
+            steadyBlocks += frameArena.frameBlockAllocations;
+    }
+
+    std::cout << "帧基准: " << frames << "帧, 每帧" << gustsPerFrame << "个阵风, 形状池" << shapePool.shapes.size()
+              << "个形状, " << seconds * 1000.0 / frames << " ms/帧" << std::endl;
+    std::cout << "帧内存池: " << (double)allocations / frames << "次分配/帧, " << bytes / frames / 1024.0
+              << " KB/帧, 堆上新块: 预热" << warmBlocks << "次 / 稳定" << steadyBlocks << "次" << std::endl;
+
+    for (auto& live : gusts)
+        pushShapeCommand(SHAPE_COMMAND_REMOVE, live.first, WindShape());
+    drainShapeCommands();
+    shapePool = std::move(savedPool);
+    windParams = savedParams;
+    shapeQueue.queuedHandles.swap(savedHandles);
+    destroyFrameArena();
+    return steadyBlocks == 0 ? 0 : 1;
+}
+
+namespace
+{
+
+// ===================== 线程布局自动调优 =====================
+// 最快的每线程像素数取决于GPU与驱动（寄存器压力、warp宽度），启动时在当前场景上逐个计时，
+// 结果按GPU/驱动标识缓存到文件，同一机器之后启动直接读取
+const int TUNE_FRAMES = 32; // 每个候选布局计时的帧数（另有GPU_TIMER_FRAMES帧预热）
+
+// GPU/驱动标识：厂商|渲染器|GL版本（版本串包含驱动版本），去掉会破坏缓存行格式的制表符
+std::string gpuDriverId()
+{
+    std::string id;
+    const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    for (GLenum name : names)
+    {
+        const char* value = (const char*)glGetString(name);
+        id += std::string(id.empty() ? "" : "|") + (value ? value : "?");
+    }
+    std::replace(id.begin(), id.end(), '\t', ' ');
+    std::replace(id.begin(), id.end(), '\n', ' ');
+    return id;
+}
+
+// 缓存文件每行：GPU/驱动标识\t像素x\t像素y
+bool readTunedLayout(const std::string& cachePath, const std::string& id, glm::ivec2& layout)
+{
+    const std::string prefix = id + "\t";
+    std::ifstream in(cachePath);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        size_t second = line.find('\t', prefix.size());
+        if (line.compare(0, prefix.size(), prefix) != 0 || second == std::string::npos)
+            continue;
+        layout = glm::ivec2(std::atoi(line.c_str() + prefix.size()), std::atoi(line.c_str() + second + 1));
+        return true;
+    }
+    return false;
+}
+
+// 改写缓存文件中该标识的一行（没有则追加），其他GPU/驱动的行保持不变
+void writeTunedLayout(const std::string& cachePath, const std::string& id, glm::ivec2 layout)
+{
+    const std::string prefix = id + "\t";
+    std::vector<std::string> lines;
+    {
+        std::ifstream in(cachePath);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (!line.empty() && line.compare(0, prefix.size(), prefix) != 0)
+                lines.push_back(line);
+        }
+    }
+    lines.push_back(prefix + std::to_string(layout.x) + "\t" + std::to_string(layout.y));
+    std::ofstream out(cachePath, std::ios::trunc);
+    for (const std::string& line : lines)
+        out << line << "\n";
+}
+
+// ===================== 库接口 =====================
+bool windFieldCreated = false; // GPU资源为模块级状态，同时只允许一个WindField
+GLuint queryFramebuffer;       // query()读取单个texel用
+
+} // namespace
+
+WindField* WindField::create(const WindFieldConfig& config, const ChunkStreamConfig& streaming)
+{
+    if (windFieldCreated)
+    {
+        std::cerr << "windrt: 已存在WindField，同时只支持一个" << std::endl;
+        return nullptr;
+    }
+    windFieldCreated = true;
+    windConfig = config;
+    chunkConfig = streaming;
+
+    initParamBuffer();
+    initTileCulling();
+    initSparseWindField();
+    initChunkStreaming();
+    initCostCounter();
+    initShapeAnimation();
+    initParticleQuery();
+    initWindMips();
+    glGenFramebuffers(1, &queryFramebuffer);
+    return new WindField();
+}
+
+WindField::~WindField()
+{
+    glDeleteFramebuffers(1, &queryFramebuffer);
+    destroyWindVariants();
+    glDeleteProgram(tileCullProgram);
+    if (allocatedTileCapacity != 0)
+        glDeleteBuffers(1, &tileListBuffer);
+    if (allocatedRTWidth != 0)
+    {
+        glDeleteTextures(1, &windRT);
+        glDeleteTextures(1, &overlapRT);
+    }
+    destroyCostCounter();
+    destroyShapeAnimation();
+    destroyParticleQuery();
+    destroyWindMips();
+    destroySparseWindField();
+    destroyChunkStreaming();
+    destroyParamBuffer();
+    drainShapeCommands(); // 释放未取出的命令
+    shapePool = ShapePoolState();
+    windParams = WindFieldParams();
+    shapeQueue.queuedHandles.clear();
+    shapeQueue.drainedCommands = 0;
+    shapeQueue.appliedCommands = 0;
+    lastShapeTests = 0;
+    dispatchTimer = nullptr;
+    destroyFrameArena();
+    allocatedRTWidth = 0;
+    allocatedRTHeight = 0;
+    allocatedMipLevels = 0;
+    allocatedTileCapacity = 0;
+    windFieldCreated = false;
+}
+
+WindShapeId WindField::addShape(const WindShape& shape)
+{
+    return addPoolShape(shapePool, shape);
+}
+
+bool WindField::updateShape(WindShapeId id, const WindShape& shape)
+{
+    return updatePoolShape(shapePool, resolveShapeId(id), shape);
+}
+
+bool WindField::removeShape(WindShapeId id)
+{
+    bool removed = removePoolShape(shapePool, resolveShapeId(id));
+    shapeQueue.queuedHandles.erase(id);
+    return removed;
+}
+
+const WindShape* WindField::findShape(WindShapeId id) const
+{
+    int dense = findPoolShape(shapePool, resolveShapeId(id));
+    return dense < 0 ? nullptr : &shapePool.shapes[dense];
+}
+
+WindShapeId WindField::queueAddShape(const WindShape& shape)
+{
+    WindShapeId id = reserveQueuedShapeId();
+    pushShapeCommand(SHAPE_COMMAND_ADD, id, shape);
+    return id;
+}
+
+void WindField::queueUpdateShape(WindShapeId id, const WindShape& shape)
+{
+    pushShapeCommand(SHAPE_COMMAND_UPDATE, id, shape);
+}
+
+void WindField::queueRemoveShape(WindShapeId id)
+{
+    pushShapeCommand(SHAPE_COMMAND_REMOVE, id, WindShape());
+}
+
+std::vector<WindLayer>& WindField::layers()
+{
+    return windLayers;
+}
+
+WindFieldConfig& WindField::config()
+{
+    return windConfig;
+}
+
+ChunkStreamConfig& WindField::streaming()
+{
+    return chunkConfig;
+}
+
+void WindField::setResolution(int width, int height, float texelSize)
+{
+    setWindResolution(width, height, texelSize);
+}
+
+void WindField::setVirtualWorld(glm::vec2 origin, glm::vec2 size)
+{
+    setWindVirtualWorld(origin, size);
+}
+
+void WindField::setPlayerPosition(glm::vec2 pos)
+{
+    playerPos = pos;
+}
+
+int WindField::warmShaderVariants()
+{
+    // 与compute()相同的步骤得到本帧的变体键：合并排队的编辑并同步形状池（只改CPU端打包结果）
+    drainShapeCommands();
+    syncShapePool(shapePool, windLayers, windParams);
+    return warmWindVariants(windVariantKey());
+}
+
+void WindField::compute(float time)
+{
+    resetFrameArena();
+    ensureWindRT();
+    drainShapeCommands();
+    // 步骤0：同步形状池的头部与图层表，CPU直接写入持久映射的参数切片（只拷贝脏槽位）
+    syncShapePool(shapePool, windLayers, windParams);
+    if (shapePool.animationsDirty)
+    {
+        uploadShapeAnimations(shapePool);
+        shapePool.animationsDirty = false;
+    }
+    if (windConfig.sparse)
+        updateWindPages(shapePool.shapes, windLayers);
+    if (chunkConfig.enabled)
+        updateChunkStreaming(playerPos);
+    WindFieldParams* slice = acquireParamSlice();
+    shapePool.uploadBytes = writeParamSlice(slice, windParams, shapePool.dirty[paramRingIndex]);
+    readShapeTestCount();
+    bindParamSlice();
+
+    // 步骤1：关键帧动画，再按tile列表计算风场，叠加烘焙的chunk风，最后生成mip链
+    dispatchShapeAnimation(time);
+    if (dispatchTimer)
+        beginGpuTimer(*dispatchTimer);
+    dispatchWindField();
+    if (dispatchTimer)
+        endGpuTimer(*dispatchTimer);
+    if (chunkConfig.enabled)
+        composeChunkWind();
+    generateWindMips();
+    releaseParamSlice();
+}
+
+glm::vec2 WindField::query(glm::vec2 worldPos) const
+{
+    // windRT由imageStore写入，读像素/取纹理之前需要对应的屏障，否则可能读到旧值
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glm::vec2 texel = glm::floor((worldPos - windConfig.worldOrigin) / windConfig.texelSize + 0.5f);
+    int x = (int)texel.x;
+    int y = (int)texel.y;
+    if (x < 0 || y < 0 || x >= allocatedRTWidth || y >= allocatedRTHeight)
+        return glm::vec2(0.0f);
+
+    glm::vec2 wind(0.0f);
+    GLint previous = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, queryFramebuffer);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, windRT, 0);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(x, y, 1, 1, GL_RG, GL_FLOAT, &wind);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previous);
+    return wind;
+}
+
+void WindField::readback(std::vector<glm::vec2>& texels, int& width, int& height) const
+{
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    width = allocatedRTWidth;
+    height = allocatedRTHeight;
+    texels.resize((size_t)width * height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, windRT);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_FLOAT, texels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void WindField::queryParticles(GLuint positions, GLuint wind, int count, int positionStride, int windStride,
+                               GLintptr positionOffset, GLintptr windOffset, float footprint)
+{
+    dispatchParticleQuery(positions, positionOffset, positionStride, wind, windOffset, windStride, count, footprint);
+}
+
+int WindField::mipLevels() const
+{
+    return allocatedMipLevels;
+}
+
+glm::ivec2 WindField::tuneThreadLayout(const std::string& cachePath, float time)
+{
+    std::string id = gpuDriverId();
+    glm::ivec2 best;
+    if (readTunedLayout(cachePath, id, best) && THREAD_LAYOUTS[threadLayoutIndex(best)] == best)
+    {
+        windConfig.pixelsPerThread = best;
+        std::cout << "线程布局（缓存）: 每线程" << best.x << "x" << best.y << "像素" << std::endl;
+        return best;
+    }
+
+    GpuTimer* userTimer = dispatchTimer;
+    double bestMs = 0.0;
+    best = THREAD_LAYOUTS[0];
+    for (const glm::ivec2& layout : THREAD_LAYOUTS)
+    {
+        windConfig.pixelsPerThread = layout;
+        // 预热：编译本布局的变体，不计时
+        dispatchTimer = nullptr;
+        for (int i = 0; i < GPU_TIMER_FRAMES; i++)
+            compute(time);
+        // 每个布局用新的计时器，只计时风场调度；结束后取回剩余查询，样本不会混入其他布局
+        GpuTimer timer;
+        initGpuTimer(timer);
+        dispatchTimer = &timer;
+        for (int i = 0; i < TUNE_FRAMES; i++)
+            compute(time);
+        glFinish();
+        finishGpuTimer(timer);
+        dispatchTimer = nullptr;
+        double ms = takeGpuTimerAverage(timer);
+        destroyGpuTimer(timer);
+        std::cout << "线程布局: 每线程" << layout.x << "x" << layout.y << "像素, " << ms << " ms" << std::endl;
+        if (layout == THREAD_LAYOUTS[0] || ms < bestMs)
+        {
+            best = layout;
+            bestMs = ms;
+        }
+    }
+    dispatchTimer = userTimer;
+
+    windConfig.pixelsPerThread = best;
+    writeTunedLayout(cachePath, id, best);
+    std::cout << "线程布局（调优）: 每线程" << best.x << "x" << best.y << "像素，已缓存到" << cachePath << std::endl;
+    return best;
+}
+
+void WindField::setDispatchTimer(GpuTimer* timer)
+{
+    dispatchTimer = timer;
+}
+
+GLuint WindField::texture() const
+{
+    return windRT;
+}
+
+GLuint WindField::overlapTexture() const
+{
+    return overlapRT;
+}
+
+WindFieldStats WindField::stats() const
+{
+    WindFieldStats s;
+    s.shapeTests = lastShapeTests;
+    s.shapes = (int)shapePool.shapes.size();
+    s.droppedShapes = shapePool.droppedShapes;
+    s.uploadBytes = shapePool.uploadBytes;
+    s.queuedCommands = shapeQueue.drainedCommands;
+    s.appliedCommands = shapeQueue.appliedCommands;
+    s.frameAllocations = frameArena.frameAllocations;
+    s.frameBytes = frameArena.frameBytes;
+    s.frameHeapBlocks = frameArena.frameBlockAllocations;
+    s.residentPages = (int)windPages.residentPages.size();
+    s.pageCapacity = windPages.atlasPages;
+    s.neededPages = (int)windPages.neededPages.size();
+    s.droppedPages = windPages.droppedPages;
+    s.residentChunks = (int)chunkStream.resident.size();
+    s.chunkCapacity = chunkStream.slotCount;
+    s.chunksInFlight = (int)chunkStream.inFlight.size();
+    s.chunkEvictions = chunkStream.evictions;
+    s.droppedBakes = chunkStream.droppedBakes;
+    s.shaderVariant = activeWindVariant;
+    s.shaderVariants = (int)windVariants.size();
+    return s;
+}
+
+} // namespace windrt
@@ -0,0 +1,324 @@
+// windrt：基于Compute Shader的2D风场库
+// 使用前需创建OpenGL 4.3+上下文并初始化GLEW，所有接口在该上下文所在的线程调用
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 所有接口位于windrt命名空间
+namespace windrt
+{
+
+// ===================== 数据结构定义 =====================
+// 形状类型枚举
+enum ShapeType : int
+{
+    SHAPE_CIRCLE = 0,
+    SHAPE_RECT = 1,
+    SHAPE_SECTOR = 2,
+    SHAPE_CAPSULE = 3,     // 胶囊：线段+半径
+    SHAPE_POLYGON = 4,     // 任意简单多边形（顶点存于顶点缓冲）
+    SHAPE_SPLINE_TUBE = 5, // 沿Catmull-Rom样条的管道
+    SHAPE_VORTEX = 6,      // 涡旋：切向风，带核半径
+    SHAPE_RADIAL = 7,      // 径向风：爆炸（向外）/内爆（向内）
+    SHAPE_SOURCE_SINK = 8  // 点源/汇：径向风按1/r衰减
+};
+const int SHAPE_TYPE_COUNT = 9;
+
+// 形状关键帧：位置、旋转、尺寸、风速，关键帧之间线性插值
+struct ShapeKeyframe
+{
+    float time;        // 时间（秒）
+    glm::vec2 pos;     // 中心位置
+    float rotation;    // 旋转角度（度）
+    glm::vec2 size;    // 尺寸
+    float windSpeed;   // 风速
+};
+
+// 单个形状的风场参数
+struct WindShape
+{
+    ShapeType type; // 形状类型
+    int padding0;
+    glm::vec2 pos;     // 中心位置 (x,y)
+    glm::vec2 size;    // 尺寸：圆形(r,0)、矩形(w,h)、扇形(r,0)、胶囊(长度,r)、样条管道(r,0)、涡旋/径向/源汇(r,核半径)
+    float rotation;    // 旋转角度（度）：矩形朝向/扇形起始角度
+    float angleRange;  // 扇形终止角度-起始角度（仅扇形有效）
+    glm::vec2 windDir; // 风向（归一化向量），涡旋/径向/源汇的风向按像素偏移计算，不使用此项
+    float windSpeed;   // 风速（向量幅值）；涡旋为负时顺时针，径向/源汇为负时向内
+    float padding1;
+    float falloff = 1.0f; // 径向风衰减指数：风速∝(1-r/R)^falloff
+    std::vector<glm::vec2> points; // 多边形顶点/样条控制点（相对pos的局部坐标，随rotation旋转）
+    std::vector<ShapeKeyframe> keyframes; // 非空时按关键帧求值（GPU按秒，定点求值器按tick），覆盖pos/rotation/size/windSpeed
+    bool loopAnimation = true;            // 关键帧是否循环播放
+    int layer = 0;                        // 所属图层（windLayers下标）
+};
+
+// ===================== 图层 =====================
+// 层内形状按覆盖率加权求和，层间按下标从小到大依次合成
+enum BlendMode : int
+{
+    BLEND_ADD = 0,           // 叠加
+    BLEND_MAX_MAGNITUDE = 1, // 取幅值较大者
+    BLEND_OVERRIDE = 2,      // 覆盖：按本层覆盖率替换下层结果
+    BLEND_MULTIPLY = 3       // 乘：下层结果乘以本层形状的风速幅值（风向不参与）
+};
+
+// 风场图层：天气、技能等整组形状的开关与区域遮罩
+struct WindLayer
+{
+    std::string name;
+    BlendMode blend = BLEND_ADD;
+    bool enabled = true;     // 关闭后整层跳过，无需重新上传形状
+    bool useMask = false;    // 遮罩：只在[maskMin, maskMax]世界区域内生效
+    bool invertMask = false; // 反转遮罩：区域内不生效
+    glm::vec2 maskMin = glm::vec2(0.0f);
+    glm::vec2 maskMax = glm::vec2(0.0f);
+};
+
+// 按名字查找图层下标，找不到返回-1
+int findWindLayer(const std::vector<WindLayer>& layers, const std::string& name);
+
+// 形状边缘抗锯齿模式：二值判定在形状移动时会产生阶梯闪烁。
+// 风场调度GPU耗时实测（--aa-bench：演示场景，1024x768 RT，100帧平均，Mesa llvmpipe软件渲染）：
+//   AA_NONE              231 ms   1.00x   二值判定
+//   AA_ANALYTIC          279 ms   1.21x   覆盖率=0.5-SDF/texel尺寸
+//   AA_SUPERSAMPLE 2x2   370 ms   1.60x   n²次二值判定取平均（n=aaSamples）
+//   AA_SUPERSAMPLE 4x4   668 ms   2.90x
+// 软件渲染的绝对值没有参考意义，倍数可作权衡参考；目标GPU上用--aa-bench重新测量
+enum AAMode : int
+{
+    AA_NONE = 0,
+    AA_ANALYTIC = 1,
+    AA_SUPERSAMPLE = 2
+};
+
+// 风场分辨率配置：与窗口尺寸解耦，运行时可修改，下一帧懒重建RT
+struct WindFieldConfig
+{
+    int rtWidth = 1024;
+    int rtHeight = 768;
+    float texelSize = 1.0f;                  // 每个texel对应的世界单位
+    glm::vec2 worldOrigin = glm::vec2(0.0f); // RT覆盖区域左下角的世界坐标
+    AAMode aaMode = AA_NONE;                 // 形状边缘抗锯齿模式
+    int aaSamples = 2;                       // 超采样每轴采样数（1~4）
+    bool costDebug = false;                  // 使用开销调试变体
+    bool sparse = false;                     // 稀疏虚拟风场：RT作为视口，世界按页驻留计算
+    glm::vec2 virtualOrigin = glm::vec2(0.0f); // 虚拟风场覆盖区域左下角的世界坐标
+    glm::vec2 virtualSize = glm::vec2(0.0f);   // 虚拟风场覆盖区域的世界尺寸
+    int atlasPages = 256;                      // 稀疏模式物理图集页数（每页64²texel RGBA32F=64KB），修改后下一帧重建并清空驻留页
+    bool mipmaps = false;                      // 每帧生成向量平均的mip链（B=区域平均风速）
+    bool sharedStaging = false;                // 风场Shader把形状分块暂存到共享内存（未经实测默认关闭，用--staging-bench对比）
+    glm::ivec2 pixelsPerThread = glm::ivec2(1); // 风场Shader每线程处理的像素：1x1/2x1/1x2/2x2/4x1，工作组=16/像素数
+};
+// 世界分块流式烘焙配置：显存预算决定图集槽位数
+struct ChunkStreamConfig
+{
+    bool enabled = false;
+    size_t memoryBudget = 2 * 1024 * 1024; // GPU图集字节数上限（RG32F，每个chunk 32KB）
+};
+// ===================== GPU计时 =====================
+// GL_TIME_ELAPSED查询环：读取几帧前的结果，避免CPU等待GPU
+const int GPU_TIMER_FRAMES = 4;
+struct GpuTimer
+{
+    GLuint queries[GPU_TIMER_FRAMES] = {0};
+    int frame = 0;         // 已发出的查询次数
+    double totalMs = 0.0;  // 已取回结果的累计耗时
+    int sampleCount = 0;   // 已取回结果的次数
+};
+
+void initGpuTimer(GpuTimer& timer);
+void beginGpuTimer(GpuTimer& timer);
+void endGpuTimer(GpuTimer& timer);
+double takeGpuTimerAverage(GpuTimer& timer); // 取平均耗时（毫秒）并清零累计
+void finishGpuTimer(GpuTimer& timer);        // 等待并取回所有未读的查询，之后查询环从头开始（换测量对象前调用）
+void destroyGpuTimer(GpuTimer& timer);
+
+// ===================== Shader编译 =====================
+// 编译并链接只含一个Compute Shader的程序（失败时输出日志）
+GLuint createComputeProgram(const std::string& source);
+
+// ===================== 确定性定点风场（锁步联机） =====================
+// 锁步联机要求各机器风场逐位一致，浮点cos/sin/atan不保证这一点。
+// 这里在CPU上用纯整数求值：坐标为Q20.12定点（世界坐标需在±131072内，保证int64不溢出），
+// 单位向量为Q16，角度为二进制角（65536=一圈），三角函数查硬编码的四分之一正弦表。
+// 只支持二值覆盖（无抗锯齿），径向风衰减指数取整；样条管道在构建时细分为线段。
+// 图层与GPU一致：按下标从小到大合成，支持开关、混合模式与二值区域遮罩（同AA_NONE，边界算在区域内）。
+// 关键帧动画与GPU一致（多边形/样条管道不动画），时间取整数tick：关键帧时间量化为毫秒，姿态在量化后的关键帧间整数插值。
+// WindShape到定点数据的量化只用IEEE基本运算（乘法+lround），编译时不要开启fast-math。
+typedef int32_t fixed_t;
+const int FIXED_SHIFT = 12; // 坐标/风速：Q20.12
+const int UNIT_SHIFT = 16;  // 单位向量：Q16
+const int FIXED_MAX_THREADS = 64;
+const int FIXED_TICKS_PER_SECOND = 1000; // 关键帧时间单位：毫秒
+
+struct FixedVec2
+{
+    fixed_t x;
+    fixed_t y;
+};
+
+// 定点形状：整数AABB用于快速剔除，其余字段按类型解释
+struct FixedShape
+{
+    ShapeType type;
+    fixed_t minX, minY, maxX, maxY; // 包围盒
+    fixed_t posX, posY;             // 中心
+    int64_t radiusSq;               // 半径平方（Q24）
+    fixed_t radius;                 // 半径 / 胶囊与管道的半径
+    fixed_t coreRadius;             // 涡旋/源汇核半径
+    fixed_t halfX, halfY;           // 矩形半尺寸 / 胶囊半长(halfX)
+    int32_t axisX, axisY;           // 矩形/胶囊方向（Q16单位向量）
+    int32_t startX, startY;         // 扇形起始方向（Q16）
+    int32_t endX, endY;             // 扇形终止方向（Q16）
+    int sectorMode;                 // 0=小于等于180°，1=大于180°，2=整圆
+    fixed_t windX, windY;           // 风向×风速
+    fixed_t strength;               // 涡旋/径向/源汇风速（带符号）
+    int falloff;                    // 径向风衰减指数（整数）
+    int firstVertex;                // 多边形顶点/管道线段在FixedWindField中的起始下标
+    int count;                      // 顶点数/线段数
+    int layer;                      // 所属图层（已按图层数截断）
+};
+
+// 定点图层：遮罩区域已量化，形状按图层分段存放
+struct FixedLayer
+{
+    BlendMode blend;
+    bool enabled;
+    bool useMask;
+    bool invertMask;
+    fixed_t maskMinX, maskMinY, maskMaxX, maskMaxY;
+    int firstShape; // 本层形状在FixedWindField::shapes中的区间
+    int shapeCount;
+};
+
+// 管道线段：中心+方向+半长，与胶囊共用局部坐标判定
+struct FixedSegment
+{
+    fixed_t centerX, centerY;
+    int32_t axisX, axisY;
+    fixed_t halfLength;
+};
+
+struct FixedWindField
+{
+    std::vector<FixedLayer> layers;
+    std::vector<FixedShape> shapes;      // 按图层分段
+    std::vector<FixedVec2> vertices;     // 多边形顶点
+    std::vector<FixedSegment> segments;  // 样条管道线段
+};
+
+fixed_t toFixed(float v);
+// layers为空时所有形状在一个叠加图层内；tick为关键帧动画时间（FIXED_TICKS_PER_SECOND为单位）
+void buildFixedWindField(const std::vector<WindShape>& shapes, const std::vector<WindLayer>& layers,
+                         FixedWindField& field, int64_t tick = 0);
+FixedVec2 evaluateFixedWind(const FixedWindField& field, FixedVec2 point);
+void evaluateFixedWindBatch(const FixedWindField& field, const FixedVec2* points, FixedVec2* out, size_t count,
+                            int threadCount);
+uint64_t hashFixedWind(const FixedVec2* values, size_t count);
+// 单线程与多线程各求值一遍并比较哈希，返回0表示一致
+int runFixedWindBenchmark(const std::vector<WindShape>& shapes, const std::vector<WindLayer>& layers, int threadCount,
+                          uint64_t expectedHash, int64_t tick = 0);
+// 无GL的逐帧CPU路径基准（命令队列、形状池、参数切片），统计帧内存池分配；稳定后仍有堆分配时返回1。
+// 与WindField共用模块级状态，不能在WindField存在时调用
+int runFrameBenchmark(int frames, int gustsPerFrame);
+
+// ===================== 风场接口 =====================
+typedef uint32_t WindShapeId; // 0为无效id
+
+// 最近一帧的统计
+struct WindFieldStats
+{
+    uint32_t shapeTests = 0;  // 形状测试次数（仅开销调试模式）
+    int shapes = 0;           // 形状总数与因桶或顶点缓冲已满未打包的形状数
+    int droppedShapes = 0;
+    size_t uploadBytes = 0;   // 本帧写入参数切片的字节数（头部+脏槽位）
+    int queuedCommands = 0;   // 本帧从命令队列取出的命令数与合并后实际执行数
+    int appliedCommands = 0;
+    int frameAllocations = 0; // 本帧帧内存池的分配次数、字节数与向堆申请新块的次数
+    size_t frameBytes = 0;
+    int frameHeapBlocks = 0;
+    int residentPages = 0;    // 稀疏模式驻留页数
+    int pageCapacity = 0;
+    int droppedPages = 0;     // 超出图集容量、未计算的页数（开始丢页时库会输出一次警告）
+    int neededPages = 0;      // 被形状覆盖的页数：超出pageCapacity时把config().atlasPages调到此值
+    int residentChunks = 0;   // 世界分块：驻留/容量/烘焙中/累计淘汰/丢弃
+    int chunkCapacity = 0;
+    int chunksInFlight = 0;
+    int chunkEvictions = 0;
+    int droppedBakes = 0;
+    uint32_t shaderVariant = 0; // 本帧风场Shader变体键（低9位=出现的形状类型）与已编译变体数
+    int shaderVariants = 0;
+};
+
+// 风场：持有形状与图层，compute()在GPU上计算风场RT。
+// GPU资源是库内的模块级状态，每个进程同时只能存在一个WindField，重复创建返回nullptr
+class WindField
+{
+public:
+    static WindField* create(const WindFieldConfig& config, const ChunkStreamConfig& streaming = ChunkStreamConfig());
+    ~WindField();
+
+    // 形状编辑均为O(1)：id带代数，形状移除后旧id失效（不会误指向复用槽位的新形状）；
+    // findShape返回的指针在下一次编辑前有效
+    WindShapeId addShape(const WindShape& shape);
+    bool updateShape(WindShapeId id, const WindShape& shape);
+    bool removeShape(WindShapeId id);
+    const WindShape* findShape(WindShapeId id) const;
+
+    // 线程安全的形状编辑：任意线程提交，下一次compute()开始时按提交顺序合并执行。
+    // queueAddShape立即返回id，可用于后续的队列命令和上面的同步接口（执行前查不到）
+    WindShapeId queueAddShape(const WindShape& shape);
+    void queueUpdateShape(WindShapeId id, const WindShape& shape);
+    void queueRemoveShape(WindShapeId id);
+
+    // 图层与配置可直接修改，下一次compute()生效
+    std::vector<WindLayer>& layers();
+    WindFieldConfig& config();
+    ChunkStreamConfig& streaming(); // memoryBudget只在创建时生效
+    void setResolution(int width, int height, float texelSize);
+    void setVirtualWorld(glm::vec2 origin, glm::vec2 size); // 开启稀疏虚拟风场
+    void setPlayerPosition(glm::vec2 pos);                  // 世界分块流式加载的中心
+
+    // 计算一帧风场；time为关键帧动画时间（秒）
+    void compute(float time);
+
+    // 同步查询与回读：会等待GPU完成本帧计算，用于工具和调试
+    glm::vec2 query(glm::vec2 worldPos) const;
+    void readback(std::vector<glm::vec2>& texels, int& width, int& height) const;
+
+    // GPU粒子查询：从positions读取count个粒子的世界坐标xy，把风速xy写入wind，全程不回读。
+    // 步长以float计（如vec4位置为4），偏移以字节计并需满足SSBO偏移对齐；在compute()之后调用。
+    // footprint为每个查询覆盖的世界尺寸，开启mip链时按它选级（远景粒子/植被取粗级，少缓存未命中）
+    void queryParticles(GLuint positions, GLuint wind, int count, int positionStride = 2, int windStride = 2,
+                        GLintptr positionOffset = 0, GLintptr windOffset = 0, float footprint = 0.0f);
+
+    // 预编译当前场景的风场Shader变体及相邻变体（多/少一种形状类型、径向衰减开关），
+    // 避免场景变化后的第一次compute()同步编译而卡顿。应在场景就绪后调用，返回新编译的变体数
+    int warmShaderVariants();
+
+    // 线程布局自动调优：在当前场景上以time逐个计时支持的每线程像素数，取最快者写入config().pixelsPerThread。
+    // 结果按GPU/驱动标识写入cachePath（同一标识只保留一行），之后同一GPU/驱动直接读取；应在场景就绪后调用。返回选中的布局
+    glm::ivec2 tuneThreadLayout(const std::string& cachePath, float time = 0.0f);
+
+    // 只对风场调度（tile剔除/清零与风场内核，不含动画、chunk合成与mip）计时，nullptr关闭
+    void setDispatchTimer(GpuTimer* timer);
+
+    GLuint texture() const;        // 风场RT（RGBA32F，RG=风向量），线性过滤；采样方可用textureLod按足迹选级
+    int mipLevels() const;         // 风场RT的mip级数（未开启mipmaps时为1）
+    GLuint overlapTexture() const; // 开销调试的重叠数RT（R32UI）
+    WindFieldStats stats() const;
+
+private:
+    WindField() = default;
+
+    std::vector<WindLayer> windLayers;
+    glm::vec2 playerPos = glm::vec2(0.0f);
+};
+
+} // namespace windrt